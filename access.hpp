@@ -21,7 +21,7 @@ namespace math
     struct ThrowAccess
     {
         template <class InputIterator>
-        constexpr typename InputIterator::value_type operator()(InputIterator begin, InputIterator end, std::ptrdiff_t index) const
+        constexpr typename std::iterator_traits<InputIterator>::value_type operator()(InputIterator begin, InputIterator end, std::ptrdiff_t index) const
         {
             if (index < 0 || index >= std::distance(begin, end))
                 throw std::out_of_range("Accessing out of the iterator range");
@@ -38,7 +38,7 @@ namespace math
         ConstantAccess(const T& value = T{}) : value(value) { }
         
         template <class InputIterator>
-        constexpr typename InputIterator::value_type operator()(InputIterator begin, InputIterator end, std::ptrdiff_t index) const
+        constexpr typename std::iterator_traits<InputIterator>::value_type operator()(InputIterator begin, InputIterator end, std::ptrdiff_t index) const
         {
             if (index < 0 || index >= std::distance(begin, end))
                 return value;
@@ -90,6 +90,18 @@ namespace math
         }
     };
     
+    //! Function object for unchecked range access
+    /*! Accesses the index as is, for ranges that are padded with enough guard elements on either side
+     @warning If the index lies outside of the range and its padding, the result is undefined */
+    struct UncheckedAccess
+    {
+        template <class InputIterator>
+        constexpr auto operator()(InputIterator begin, InputIterator, std::ptrdiff_t index) const
+        {
+            return *std::next(begin, index);
+        }
+    };
+    
     //! Access element in a range, taking an accessor for out-of-range handling
     template <class InputIterator, class Accessor = ThrowAccess>
     auto access(InputIterator begin, InputIterator end, std::ptrdiff_t index, Accessor accessor = Accessor())
@@ -0,0 +1,247 @@
+//
+//  additive.hpp
+//  Math
+//
+//  Copyright © 2015-2016 Dsperados (info@dsperados.com). All rights reserved.
+//  Licensed under the BSD 3-clause license.
+//
+
+#ifndef DSPERADOS_MATH_ADDITIVE_HPP
+#define DSPERADOS_MATH_ADDITIVE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "constants.hpp"
+
+namespace math
+{
+    //! The number of samples the additive synthesizer renders per pass over the partials
+    constexpr std::size_t ADDITIVE_CHUNK_SIZE = 64;
+    
+    //! Additive synthesizer, rendering the sum of many sinusoidal partials
+    /*! Every partial is a recursive oscillator: a phasor rotated by a fixed step per sample, so no
+        sin() or cos() is called per sample. The partials are stored as a structure of arrays and
+        processed LANES at a time, each group kept in registers for a chunk of samples, so the update
+        vectorizes across partials. Frequencies and amplitudes can ramp linearly to new targets over a
+        block; a frequency ramp rotates the step itself by a constant chirp each sample.
+        
+        @code{cpp}
+        AdditiveSynthesizer<float> synthesizer(1000);
+        synthesizer.setPartials(frequencies.data(), amplitudes.data(), phases.data());
+        
+        // Every block, glide to new targets
+        synthesizer.process(output.data(), output.size(), newFrequencies.data(), newAmplitudes.data());
+        @endcode */
+    template <typename T>
+    class AdditiveSynthesizer
+    {
+    public:
+        //! The number of partials processed side-by-side
+        static constexpr std::size_t LANES = 8;
+        
+    public:
+        //! Construct the synthesizer with a number of silent partials
+        AdditiveSynthesizer(std::size_t partialCount) :
+            partialCount(partialCount)
+        {
+            // Pad to a whole number of lanes with silent partials
+            const auto padded = (partialCount + LANES - 1) / LANES * LANES;
+            real.assign(padded, 1);
+            imag.assign(padded, 0);
+            stepReal.assign(padded, 1);
+            stepImag.assign(padded, 0);
+            chirpReal.assign(padded, 1);
+            chirpImag.assign(padded, 0);
+            amplitudes.assign(padded, 0);
+            amplitudeDeltas.assign(padded, 0);
+            frequencies.assign(padded, 0);
+        }
+        
+        //! Set the frequencies, amplitudes and phases of all partials immediately
+        /*! @param frequencies The frequencies in cycles per sample
+            @param amplitudes The peak amplitudes
+            @param phases The phases in radians, or nullptr to leave the phases untouched */
+        void setPartials(const double* frequencies, const T* amplitudes, const double* phases = nullptr)
+        {
+            for (std::size_t p = 0; p < partialCount; ++p)
+            {
+                this->frequencies[p] = frequencies[p];
+                stepReal[p] = static_cast<T>(std::cos(TAU<double> * frequencies[p]));
+                stepImag[p] = static_cast<T>(std::sin(TAU<double> * frequencies[p]));
+                this->amplitudes[p] = amplitudes[p];
+                
+                if (phases)
+                {
+                    real[p] = static_cast<T>(std::cos(phases[p]));
+                    imag[p] = static_cast<T>(std::sin(phases[p]));
+                }
+            }
+        }
+        
+        //! Render the sum of all partials, holding their frequencies and amplitudes
+        void process(T* out, std::size_t size)
+        {
+            std::fill(amplitudeDeltas.begin(), amplitudeDeltas.end(), 0);
+            render<false>(out, size);
+            renormalize(real, imag);
+        }
+        
+        //! Render the sum of all partials, ramping their frequencies and amplitudes linearly to new targets
+        /*! The targets are reached at the end of the block
+            @param targetFrequencies The frequencies in cycles per sample, or nullptr to hold the frequencies
+            @param targetAmplitudes The peak amplitudes, or nullptr to hold the amplitudes */
+        void process(T* out, std::size_t size, const double* targetFrequencies, const T* targetAmplitudes)
+        {
+            if (size == 0)
+                return;
+            
+            std::fill(amplitudeDeltas.begin(), amplitudeDeltas.end(), 0);
+            if (targetAmplitudes)
+            {
+                for (std::size_t p = 0; p < partialCount; ++p)
+                    amplitudeDeltas[p] = (targetAmplitudes[p] - amplitudes[p]) / static_cast<T>(size);
+            }
+            
+            if (targetFrequencies)
+            {
+                for (std::size_t p = 0; p < partialCount; ++p)
+                {
+                    const auto delta = TAU<double> * (targetFrequencies[p] - frequencies[p]) / size;
+                    chirpReal[p] = static_cast<T>(std::cos(delta));
+                    chirpImag[p] = static_cast<T>(std::sin(delta));
+                }
+                
+                render<true>(out, size);
+                
+                // Land exactly on the target frequencies, rather than on the accumulated chirps
+                for (std::size_t p = 0; p < partialCount; ++p)
+                {
+                    frequencies[p] = targetFrequencies[p];
+                    stepReal[p] = static_cast<T>(std::cos(TAU<double> * frequencies[p]));
+                    stepImag[p] = static_cast<T>(std::sin(TAU<double> * frequencies[p]));
+                }
+            }
+            else
+            {
+                render<false>(out, size);
+            }
+            
+            if (targetAmplitudes)
+                std::copy(targetAmplitudes, targetAmplitudes + partialCount, amplitudes.begin());
+            
+            renormalize(real, imag);
+        }
+        
+        //! The number of partials
+        std::size_t getPartialCount() const { return partialCount; }
+        
+    private:
+        //! Sum the partials, LANES partials at a time
+        /*! Each group of partials is kept in local arrays for a whole chunk of samples, accumulating into
+            one column per lane, so the lane loop maps onto a single vector */
+        template <bool Chirp>
+        void render(T* out, std::size_t size)
+        {
+            for (std::size_t offset = 0; offset < size; offset += ADDITIVE_CHUNK_SIZE)
+            {
+                const auto count = std::min(size - offset, ADDITIVE_CHUNK_SIZE);
+                T accumulated[ADDITIVE_CHUNK_SIZE * LANES] = {};
+                
+                for (std::size_t group = 0; group < real.size(); group += LANES)
+                {
+                    T re[LANES], im[LANES], sr[LANES], si[LANES], cr[LANES], ci[LANES], amplitude[LANES], delta[LANES];
+                    for (std::size_t k = 0; k < LANES; ++k)
+                    {
+                        re[k] = real[group + k];
+                        im[k] = imag[group + k];
+                        sr[k] = stepReal[group + k];
+                        si[k] = stepImag[group + k];
+                        cr[k] = chirpReal[group + k];
+                        ci[k] = chirpImag[group + k];
+                        amplitude[k] = amplitudes[group + k];
+                        delta[k] = amplitudeDeltas[group + k];
+                    }
+                    
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        for (std::size_t k = 0; k < LANES; ++k)
+                        {
+                            accumulated[i * LANES + k] += im[k] * amplitude[k];
+                            amplitude[k] += delta[k];
+                            
+                            const auto r = re[k] * sr[k] - im[k] * si[k];
+                            im[k] = re[k] * si[k] + im[k] * sr[k];
+                            re[k] = r;
+                            
+                            if (Chirp)
+                            {
+                                const auto s = sr[k] * cr[k] - si[k] * ci[k];
+                                si[k] = sr[k] * ci[k] + si[k] * cr[k];
+                                sr[k] = s;
+                            }
+                        }
+                    }
+                    
+                    for (std::size_t k = 0; k < LANES; ++k)
+                    {
+                        real[group + k] = re[k];
+                        imag[group + k] = im[k];
+                        stepReal[group + k] = sr[k];
+                        stepImag[group + k] = si[k];
+                        amplitudes[group + k] = amplitude[k];
+                    }
+                }
+                
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    T total = 0;
+                    for (std::size_t k = 0; k < LANES; ++k)
+                        total += accumulated[i * LANES + k];
+                    
+                    out[offset + i] = total;
+                }
+            }
+        }
+        
+        //! Pull phasors back onto the unit circle with a Newton step
+        static void renormalize(std::vector<T>& re, std::vector<T>& im)
+        {
+            for (std::size_t p = 0; p < re.size(); ++p)
+            {
+                const auto gain = T{1.5} - T{0.5} * (re[p] * re[p] + im[p] * im[p]);
+                re[p] *= gain;
+                im[p] *= gain;
+            }
+        }
+        
+    private:
+        //! The number of partials, without padding
+        std::size_t partialCount = 0;
+        
+        //! The phasor per partial
+        std::vector<T> real;
+        std::vector<T> imag;
+        
+        //! The rotation per sample per partial
+        std::vector<T> stepReal;
+        std::vector<T> stepImag;
+        
+        //! The rotation of the step per sample during a frequency ramp
+        std::vector<T> chirpReal;
+        std::vector<T> chirpImag;
+        
+        //! The amplitude per partial
+        std::vector<T> amplitudes;
+        
+        //! The amplitude change per sample during an amplitude ramp
+        std::vector<T> amplitudeDeltas;
+        
+        //! The frequency per partial, in cycles per sample
+        std::vector<double> frequencies;
+    };
+}
+
+#endif
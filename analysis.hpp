@@ -13,33 +13,155 @@
 #include <cmath>
 #include <cstddef>
 #include <iterator>
+#include <type_traits>
 #include <vector>
 
 namespace math
 {
+    //! The number of columns a vectorized reduction keeps side-by-side
+    constexpr std::size_t REDUCTION_LANES = 64;
+    
+    //! Visit a signal REDUCTION_LANES samples at a time, passing every sample along with its column
+    /*! Lets a reduction keep an accumulator per column, so its loop vectorizes without reassociating a
+        single accumulator. The remainder is visited in the first columns.
+        
+        @code{cpp}
+        float sums[REDUCTION_LANES] = {};
+        reduceColumns(data, size, [&](std::size_t k, float x){ sums[k] += x * x; });
+        @endcode */
+    template <typename T, typename Function>
+    void reduceColumns(const T* data, std::size_t size, Function function)
+    {
+        std::size_t i = 0;
+        for (; i + REDUCTION_LANES <= size; i += REDUCTION_LANES)
+        {
+            for (std::size_t k = 0; k < REDUCTION_LANES; ++k)
+                function(k, data[i + k]);
+        }
+        
+        for (std::size_t k = 0; i + k < size; ++k)
+            function(k, data[i + k]);
+    }
+    
+    //! The sample with the largest absolute value in a signal, and its position
+    template <typename T>
+    struct Peak
+    {
+        //! The sample, with its sign
+        T value = 0;
+        
+        //! The position of the sample
+        std::size_t index = 0;
+    };
+    
+    //! Find the sample with the largest absolute value
+    /*! In case of multiple peaks, returns the first one. A NaN counts as larger than any number,
+        so the first NaN is returned if there is one. An empty signal returns a value of zero.
+        
+        The signal is reduced into REDUCTION_LANES columns, each remembering its largest value and
+        where it was found, so the loop vectorizes. */
+    template <typename T>
+    Peak<T> findPeak(const T* data, std::size_t size)
+    {
+        T columns[REDUCTION_LANES] = {};
+        std::size_t indices[REDUCTION_LANES] = {};
+        T nans[REDUCTION_LANES] = {};
+        
+        std::size_t i = 0;
+        for (; i + REDUCTION_LANES <= size; i += REDUCTION_LANES)
+        {
+            for (std::size_t k = 0; k < REDUCTION_LANES; ++k)
+            {
+                // Strictly larger, so each column keeps its first peak
+                const T x = std::abs(data[i + k]);
+                const bool larger = columns[k] < x;
+                columns[k] = larger ? x : columns[k];
+                indices[k] = larger ? i + k : indices[k];
+                nans[k] += x != x ? T{1} : T{0};
+            }
+        }
+        
+        // Merge the columns, preferring the first position among equal peaks
+        T magnitude = 0;
+        std::size_t index = 0;
+        T nan = 0;
+        for (std::size_t k = 0; k < REDUCTION_LANES; ++k)
+        {
+            if (magnitude < columns[k] || (magnitude == columns[k] && indices[k] < index))
+            {
+                magnitude = columns[k];
+                index = indices[k];
+            }
+            
+            nan += nans[k];
+        }
+        
+        // The remainder comes after all columns, so only a strictly larger value replaces the peak
+        for (; i < size; ++i)
+        {
+            const T x = std::abs(data[i]);
+            nan += x != x ? T{1} : T{0};
+            if (magnitude < x)
+            {
+                magnitude = x;
+                index = i;
+            }
+        }
+        
+        if (nan > 0)
+            index = static_cast<std::size_t>(std::find_if(data, data + size, [](const T& x){ return x != x; }) - data);
+        
+        Peak<T> peak;
+        if (size > 0)
+        {
+            peak.value = data[index];
+            peak.index = index;
+        }
+        
+        return peak;
+    }
+    
     //! Find the hightest minimum or maximum value
-    /*! In case of multiple extrema, return the first element */
+    /*! In case of multiple extrema, return the first element. A NaN counts as larger than any number.
+        Pointers and vector iterators are searched with the vectorized findPeak(). */
     template <typename Iterator>
     Iterator findExtrema(Iterator begin, Iterator end)
     {
-        auto range = std::minmax_element(begin, end);
-        const auto min = std::abs(*range.first);
-        if (min == *range.second)
-            return std::min(range.first, range.second);
-        else if (min < *range.second)
-            return range.second;
+        using Value = typename std::iterator_traits<Iterator>::value_type;
+        if constexpr (std::is_pointer<Iterator>::value || std::is_same<Iterator, typename std::vector<Value>::iterator>::value || std::is_same<Iterator, typename std::vector<Value>::const_iterator>::value)
+        {
+            if (begin == end)
+                return end;
+            
+            return std::next(begin, findPeak(&*begin, static_cast<std::size_t>(std::distance(begin, end))).index);
+        }
         else
-            return range.first;
+        {
+            auto peak = begin;
+            for (auto it = begin; it != end; ++it)
+            {
+                const auto magnitude = std::abs(*it);
+                const auto peakMagnitude = std::abs(*peak);
+                if (peakMagnitude != peakMagnitude)
+                    break;
+                
+                if (peakMagnitude < magnitude || magnitude != magnitude)
+                    peak = it;
+            }
+            
+            return peak;
+        }
     }
     
-    //! Find the local minima of a signal
-    template <typename Iterator>
-    std::vector<size_t> findLocalMinimaPositions(Iterator begin, Iterator end)
+    //! Find the local minima of a signal, writing their positions to an output iterator
+    /*! Doesn't allocate, so it can be used on real-time threads with a preallocated output */
+    template <typename Iterator, typename OutputIterator>
+    OutputIterator findLocalMinimaPositions(Iterator begin, Iterator end, OutputIterator out)
     {
         // If we only received two points or less, there is no minimum
         const auto d = std::distance(begin, end);
         if (d < 3)
-            return {};
+            return out;
         
         // Store three iterators for the previous, current and next sample
         auto p = begin;
@@ -47,29 +169,39 @@ namespace math
         auto n = std::next(c);
         
         // Loop through the range, storing the position of each minimum
-        std::vector<size_t> minima;
-        for (size_t pos = 1; c != end; ++pos)
+        for (size_t pos = 1; n != end; ++pos)
         {
             // Is the previous sample bigger than the current, and the current smaller or equal than the next?
             if (*p > *c && *c <= *n)
-                minima.emplace_back(pos);
+                *out++ = pos;
             
             // Move the iterators forward
             p = c;
             c = n++;
         }
         
-        return minima;
+        return out;
     }
     
     //! Find the local minima of a signal
     template <typename Iterator>
-    std::vector<size_t> findLocalMaximaPositions(Iterator begin, Iterator end)
+    std::vector<size_t> findLocalMinimaPositions(Iterator begin, Iterator end)
+    {
+        std::vector<size_t> minima;
+        findLocalMinimaPositions(begin, end, std::back_inserter(minima));
+        
+        return minima;
+    }
+    
+    //! Find the local maxima of a signal, writing their positions to an output iterator
+    /*! Doesn't allocate, so it can be used on real-time threads with a preallocated output */
+    template <typename Iterator, typename OutputIterator>
+    OutputIterator findLocalMaximaPositions(Iterator begin, Iterator end, OutputIterator out)
     {
         // If we only received two points or less, there is no maximum
         const auto d = std::distance(begin, end);
         if (d < 3)
-            return {};
+            return out;
         
         // Store three iterators for the previous, current and next sample
         auto p = begin;
@@ -77,18 +209,27 @@ namespace math
         auto n = std::next(c);
         
         // Loop through the range, storing the position of each maximum
-        std::vector<size_t> maxima;
-        for (size_t pos = 1; c != end; ++pos)
+        for (size_t pos = 1; n != end; ++pos)
         {
             // Is the previous sample smaller than the current, and the current bigger or equal than the next?
             if (*p < *c && *c >= *n)
-                maxima.emplace_back(pos);
+                *out++ = pos;
             
             // Move the iterators forward
             p = c;
             c = n++;
         }
         
+        return out;
+    }
+    
+    //! Find the local maxima of a signal
+    template <typename Iterator>
+    std::vector<size_t> findLocalMaximaPositions(Iterator begin, Iterator end)
+    {
+        std::vector<size_t> maxima;
+        findLocalMaximaPositions(begin, end, std::back_inserter(maxima));
+        
         return maxima;
     }
     
@@ -0,0 +1,433 @@
+//
+//  approximation.hpp
+//  Math
+//
+//  Copyright © 2015-2016 Dsperados (info@dsperados.com). All rights reserved.
+//  Licensed under the BSD 3-clause license.
+//
+
+#ifndef DSPERADOS_MATH_APPROXIMATION_HPP
+#define DSPERADOS_MATH_APPROXIMATION_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "constants.hpp"
+
+namespace math
+{
+    //! The accuracy tiers of the fast approximations
+    /*! The tiers trade polynomial degree for accuracy. The maximum errors, measured against a
+        long double reference over the documented domains, are listed with every function. */
+    enum class Accuracy
+    {
+        LOW, //!< Relative error below 6e-5, plenty for control signals and modulation
+        MEDIUM, //!< Within a few ULP in float, relative error below 3e-7 in double
+        HIGH //!< Within a few ULP in double
+    };
+    
+    //! Minimax polynomial coefficients for the fast approximations, per accuracy tier
+    /*! Computed with the Remez algorithm, minimizing the relative error of:
+        - sin(r) = r + r^3 * P(r^2) and cos(r) = 1 + r^2 * P(r^2) for |r| <= π/4
+        - atan(r) = r + r^3 * P(r^2) for |r| <= tan(π/8)
+        - exp(r) = 1 + r + r^2 * P(r) for |r| <= ln(2)/2
+        - log(m) = 2s + s^3 * P(s^2) with s = (m - 1) / (m + 1), for √½ <= m < √2 */
+    template <Accuracy A>
+    struct ApproximationCoefficients;
+    
+    template <>
+    struct ApproximationCoefficients<Accuracy::LOW>
+    {
+        static constexpr std::array<double, 2> sin = {-0.166633903770567132177, 0.00816328191662827726564};
+        static constexpr std::array<double, 3> cos = {-0.499998847459078679935, 0.0416557770432122887074, -0.00135918535670541993012};
+        static constexpr std::array<double, 3> atan = {-0.333255077868340167266, 0.197141437748942947886, -0.112251630827996950655};
+        static constexpr std::array<double, 3> exp = {0.500051160153608940614, 0.167535139150534609258, 0.0412777480662992518633};
+        static constexpr std::array<double, 1> log = {0.67660440765448409736};
+    };
+    
+    template <>
+    struct ApproximationCoefficients<Accuracy::MEDIUM>
+    {
+        static constexpr std::array<double, 3> sin = {-0.166666546095474183121, 0.00833216076180118121843, -0.000195152831853894337045};
+        static constexpr std::array<double, 4> cos = {-0.499999996944760028173, 0.0416666203571307094117, -0.0013886681647931936276, 0.0000243835673055993793779};
+        static constexpr std::array<double, 5> atan = {-0.33333315188659927888, 0.199984715184464997668, -0.142435334015738817649, 0.105938141516861650684, -0.0607822246785804919147};
+        static constexpr std::array<double, 5> exp = {0.499999934517084335897, 0.166665206898330188061, 0.0416683873612611455482, 0.00836870982417119432296, 0.00138146132607797708093};
+        static constexpr std::array<double, 2> log = {0.66655622015289427172, 0.412019945443146632951};
+    };
+    
+    template <>
+    struct ApproximationCoefficients<Accuracy::HIGH>
+    {
+        static constexpr std::array<double, 6> sin = {-0.166666666666666307295, 0.0083333333333221185938, -0.000198412698295895425824, 0.0000027557313621387064446, -2.50507477630564069007e-8, 1.58962301683665689649e-10};
+        static constexpr std::array<double, 7> cos = {-0.499999999999999995098, 0.0416666666666664698485, -0.00138888888888619999096, 0.0000248015872840946205347, -2.75573131172906584767e-7, 2.08755821269538931677e-9, -1.13532812468059185585e-11};
+        static constexpr std::array<double, 11> atan = {-0.333333333333331961688, 0.199999999999532482275, -0.142857142801666443996, 0.111111107821590904183, -0.0909089772536842422414, 0.0769205971950011519841, -0.0666309922727198455639, 0.0584785944426812605822, -0.0503919119625293826194, 0.038062159472666681649, -0.0179050609444712439695};
+        static constexpr std::array<double, 10> exp = {0.500000000000001021428, 0.166666666666666745217, 0.0416666666665221064846, 0.00833333333332221619646, 0.00138888889477855228546, 0.000198412698865638016736, 0.0000248014873660256761719, 0.00000275572423674496577736, 2.76326406754302357073e-7, 2.51100382967272432195e-8};
+        static constexpr std::array<double, 6> log = {0.666666666665874953563, 0.400000000521361686394, 0.285714171512694741532, 0.222233702189713242829, 0.181236878926354684813, 0.168192999303090069223};
+    };
+    
+    //! Floating-point layout and range reduction constants for the fast approximations
+    template <typename T>
+    struct ApproximationConstants;
+    
+    template <>
+    struct ApproximationConstants<float>
+    {
+        using Bits = std::int32_t;
+        
+        static constexpr int MANTISSA_BITS = 23;
+        static constexpr int EXPONENT_BIAS = 127;
+        
+        //! Adding and subtracting this rounds to the nearest integer, for |x| < 2^22
+        /*! Relies on strict floating-point semantics, so don't build with -ffast-math */
+        static constexpr float ROUNDER = 12582912.0f;
+        
+        //! π/2, split into parts whose product with small integers is exact
+        static constexpr float HALF_PI_1 = 1.5703125f;
+        static constexpr float HALF_PI_2 = 4.837512969970703125e-4f;
+        static constexpr float HALF_PI_3 = 7.549533620476722717285156e-8f;
+        static constexpr float HALF_PI_4 = 2.563344068257089602980159e-12f;
+        
+        //! ln(2), split into parts whose product with small integers is exact
+        static constexpr float LN2_HI = 0.693359375f;
+        static constexpr float LN2_LO = -2.12194440e-4f;
+        
+        //! The range of exp() that results in a normal number
+        static constexpr float EXP_MIN = -87.3365447f;
+        static constexpr float EXP_MAX = 88.7228394f;
+    };
+    
+    template <>
+    struct ApproximationConstants<double>
+    {
+        using Bits = std::int64_t;
+        
+        static constexpr int MANTISSA_BITS = 52;
+        static constexpr int EXPONENT_BIAS = 1023;
+        
+        //! Adding and subtracting this rounds to the nearest integer, for |x| < 2^51
+        /*! Relies on strict floating-point semantics, so don't build with -ffast-math */
+        static constexpr double ROUNDER = 6755399441055744.0;
+        
+        //! π/2, split into parts whose product with small integers is exact
+        static constexpr double HALF_PI_1 = 1.57079632673412561417e+00;
+        static constexpr double HALF_PI_2 = 6.07710050630396597660e-11;
+        static constexpr double HALF_PI_3 = 2.02226624871116645580e-21;
+        static constexpr double HALF_PI_4 = 8.47842766036889956997e-32;
+        
+        //! ln(2), split into parts whose product with small integers is exact
+        static constexpr double LN2_HI = 6.93147180369123816490e-01;
+        static constexpr double LN2_LO = 1.90821492927058770002e-10;
+        
+        //! The range of exp() that results in a normal number
+        static constexpr double EXP_MIN = -708.3964185322641;
+        static constexpr double EXP_MAX = 709.782712893384;
+    };
+    
+    //! Evaluate a polynomial c[0] + c[1] * x + c[2] * x^2 + ... using Horner's scheme
+    template <typename T, std::size_t N>
+    inline T evaluatePolynomial(T x, const std::array<double, N>& c)
+    {
+        T result = static_cast<T>(c[N - 1]);
+        for (auto i = N - 1; i > 0; --i)
+            result = result * x + static_cast<T>(c[i - 1]);
+        
+        return result;
+    }
+    
+    //! Reduce an angle to [-π/4, π/4], returning the quadrant
+    /*! The reduction is exact while the quadrant count fits the mantissa, for |x| below 2^22 π/2 in
+        float and 2^51 π/2 in double. Larger arguments, infinities and NaN give a meaningless quadrant,
+        but the conversion to an integer is always defined. */
+    template <typename T>
+    inline std::int32_t reduceQuarterPi(T x, T& r)
+    {
+        using C = ApproximationConstants<T>;
+        
+        const T q = (x * static_cast<T>(2 / PI<double>) + C::ROUNDER) - C::ROUNDER;
+        r = (((x - q * C::HALF_PI_1) - q * C::HALF_PI_2) - q * C::HALF_PI_3) - q * C::HALF_PI_4;
+        
+        // Only the lowest two bits are used, so reduce modulo 4 in floating point before converting,
+        // and clamp the result so large and non-finite arguments can't overflow the integer
+        const T n = (q * static_cast<T>(0.25) + C::ROUNDER) - C::ROUNDER;
+        const T quadrant = std::min(static_cast<T>(4), std::max(static_cast<T>(-4), q - 4 * n));
+        
+        return static_cast<std::int32_t>(quadrant);
+    }
+    
+    //! Approximate sin(r) for |r| <= π/4
+    template <Accuracy A, typename T>
+    inline T sinPolynomial(T r)
+    {
+        const auto z = r * r;
+        return r + r * z * evaluatePolynomial(z, ApproximationCoefficients<A>::sin);
+    }
+    
+    //! Approximate cos(r) for |r| <= π/4
+    template <Accuracy A, typename T>
+    inline T cosPolynomial(T r)
+    {
+        const auto z = r * r;
+        return 1 + z * evaluatePolynomial(z, ApproximationCoefficients<A>::cos);
+    }
+    
+    //! Approximate atan(t) for 0 <= t <= 1
+    template <Accuracy A, typename T>
+    inline T atanPolynomial(T t)
+    {
+        // Above tan(π/8), use atan(t) = π/4 + atan((t - 1) / (t + 1))
+        const bool upper = t > static_cast<T>(0.41421356237309504880);
+        const auto u = upper ? (t - 1) / (t + 1) : t;
+        const auto z = u * u;
+        const auto result = u + u * z * evaluatePolynomial(z, ApproximationCoefficients<A>::atan);
+        
+        return upper ? result + QUARTER_PI<T> : result;
+    }
+    
+    //! Fast sine approximation
+    /*! Maximum error for |x| <= 1e4 in float: LOW 27 ULP, MEDIUM 3 ULP. For |x| <= 1e6 in double: HIGH 3 ULP.
+        Accuracy degrades for larger arguments, as the range reduction uses a four-part Cody-Waite
+        split of π/2 instead of Payne-Hanek. */
+    template <Accuracy A = Accuracy::MEDIUM, typename T>
+    inline T fastSin(T x)
+    {
+        T r;
+        const auto quadrant = reduceQuarterPi(x, r);
+        const auto s = sinPolynomial<A>(r);
+        const auto c = cosPolynomial<A>(r);
+        const auto result = (quadrant & 1) ? c : s;
+        
+        return (quadrant & 2) ? -result : result;
+    }
+    
+    //! Fast cosine approximation
+    /*! Maximum error for |x| <= 1e4 in float: LOW 27 ULP, MEDIUM 3 ULP. For |x| <= 1e6 in double: HIGH 3 ULP. */
+    template <Accuracy A = Accuracy::MEDIUM, typename T>
+    inline T fastCos(T x)
+    {
+        T r;
+        const auto quadrant = reduceQuarterPi(x, r);
+        const auto s = sinPolynomial<A>(r);
+        const auto c = cosPolynomial<A>(r);
+        const auto result = (quadrant & 1) ? s : c;
+        
+        return ((quadrant + 1) & 2) ? -result : result;
+    }
+    
+    //! Fast tangent approximation
+    /*! Maximum error for |x| <= 1e4 in float: LOW 34 ULP, MEDIUM 4 ULP. For |x| <= 1e6 in double: HIGH 4 ULP. */
+    template <Accuracy A = Accuracy::MEDIUM, typename T>
+    inline T fastTan(T x)
+    {
+        T r;
+        const auto quadrant = reduceQuarterPi(x, r);
+        const auto s = sinPolynomial<A>(r);
+        const auto c = cosPolynomial<A>(r);
+        
+        return (quadrant & 1) ? -c / s : s / c;
+    }
+    
+    //! Fast arc tangent approximation
+    /*! Maximum error in float: LOW 12 ULP, MEDIUM 3 ULP. In double: HIGH 3 ULP. */
+    template <Accuracy A = Accuracy::MEDIUM, typename T>
+    inline T fastAtan(T x)
+    {
+        // Above 1, use atan(x) = π/2 - atan(1 / x)
+        const auto ax = std::abs(x);
+        const bool inverted = ax > 1;
+        const auto result = atanPolynomial<A>(inverted ? 1 / ax : ax);
+        
+        return std::copysign(inverted ? HALF_PI<T> - result : result, x);
+    }
+    
+    //! Fast approximation of the arc tangent of y / x, using the signs to determine the quadrant
+    /*! Maximum error in float: LOW 12 ULP, MEDIUM 3 ULP. In double: HIGH 3 ULP. Returns 0 for atan2(0, 0). */
+    template <Accuracy A = Accuracy::MEDIUM, typename T>
+    inline T fastAtan2(T y, T x)
+    {
+        const auto ax = std::abs(x);
+        const auto ay = std::abs(y);
+        const auto max = ax > ay ? ax : ay;
+        const auto min = ax > ay ? ay : ax;
+        
+        auto result = atanPolynomial<A>(max == 0 ? T{0} : min / max);
+        result = ay > ax ? HALF_PI<T> - result : result;
+        result = std::signbit(x) ? PI<T> - result : result;
+        
+        return std::copysign(result, y);
+    }
+    
+    //! Fast exponential approximation
+    /*! Maximum error in float: LOW 71 ULP, MEDIUM 2 ULP. In double: HIGH 2 ULP. Results that would
+        be subnormal are flushed to zero. */
+    template <Accuracy A = Accuracy::MEDIUM, typename T>
+    inline T fastExp(T x)
+    {
+        using C = ApproximationConstants<T>;
+        using Bits = typename C::Bits;
+        
+        // Split x into n * ln(2) + r, with |r| <= ln(2) / 2, clamping NaN too so n always fits the integer
+        const auto clamped = x > C::EXP_MIN ? (x < C::EXP_MAX ? x : C::EXP_MAX) : C::EXP_MIN;
+        const T n = (clamped * static_cast<T>(1 / 0.69314718055994530942) + C::ROUNDER) - C::ROUNDER;
+        const auto r = (clamped - n * C::LN2_HI) - n * C::LN2_LO;
+        auto result = 1 + r + r * r * evaluatePolynomial(r, ApproximationCoefficients<A>::exp);
+        
+        // Construct 2^n in the exponent bits, keeping n below the exponent of infinity
+        auto exponent = static_cast<Bits>(n);
+        const bool top = exponent > C::EXPONENT_BIAS;
+        exponent -= top;
+        result *= top ? 2 : 1;
+        
+        const Bits bits = (exponent + C::EXPONENT_BIAS) << C::MANTISSA_BITS;
+        T scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+        result *= scale;
+        
+        result = x > C::EXP_MAX ? std::numeric_limits<T>::infinity() : result;
+        result = x < C::EXP_MIN ? 0 : result;
+        return x != x ? x : result;
+    }
+    
+    //! Fast natural logarithm approximation
+    /*! Maximum error in float: LOW 480 ULP, MEDIUM 5 ULP. In double: HIGH 4 ULP. Returns NaN for
+        negative input and -infinity for zero. */
+    template <Accuracy A = Accuracy::MEDIUM, typename T>
+    inline T fastLog(T x)
+    {
+        using C = ApproximationConstants<T>;
+        using Bits = typename C::Bits;
+        
+        // Scale subnormal numbers up, so the exponent bits can be read directly
+        const bool subnormal = x < std::numeric_limits<T>::min();
+        const auto scaled = subnormal ? x * static_cast<T>(Bits{1} << C::MANTISSA_BITS) : x;
+        
+        // Split x into m * 2^e, with √½ <= m < √2
+        Bits bits;
+        std::memcpy(&bits, &scaled, sizeof(bits));
+        auto e = ((bits >> C::MANTISSA_BITS) & ((1 << (sizeof(T) * 8 - 1 - C::MANTISSA_BITS)) - 1)) - C::EXPONENT_BIAS - (subnormal ? C::MANTISSA_BITS : 0);
+        bits = (bits & ((Bits{1} << C::MANTISSA_BITS) - 1)) | (Bits{C::EXPONENT_BIAS} << C::MANTISSA_BITS);
+        T m;
+        std::memcpy(&m, &bits, sizeof(m));
+        
+        const bool upper = m > SQRT_TWO<T>;
+        m = upper ? m * T{0.5} : m;
+        e += upper;
+        
+        // log(m) = 2 * atanh(s)
+        const auto s = (m - 1) / (m + 1);
+        const auto z = s * s;
+        const auto logm = 2 * s + s * z * evaluatePolynomial(z, ApproximationCoefficients<A>::log);
+        const auto n = static_cast<T>(e);
+        auto result = n * C::LN2_HI + (logm + n * C::LN2_LO);
+        
+        // Blend in the special cases with bit operations, otherwise compilers move the division into a branch
+        const auto special = x == 0 ? -std::numeric_limits<T>::infinity() : (x > 0 ? x : std::numeric_limits<T>::quiet_NaN());
+        const bool regular = (x > 0) & (x < std::numeric_limits<T>::infinity());
+        Bits resultBits, specialBits;
+        std::memcpy(&resultBits, &result, sizeof(resultBits));
+        std::memcpy(&specialBits, &special, sizeof(specialBits));
+        const Bits mask = -static_cast<Bits>(regular);
+        resultBits = (resultBits & mask) | (specialBits & ~mask);
+        std::memcpy(&result, &resultBits, sizeof(result));
+        
+        return result;
+    }
+    
+    //! Fast sine approximation of an array
+    /*! A plain loop over the inlined scalar approximation, which compilers vectorize at -O3 */
+    template <Accuracy A = Accuracy::MEDIUM, typename T>
+    void fastSin(const T* in, T* out, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+            out[i] = fastSin<A>(in[i]);
+    }
+    
+    //! Fast cosine approximation of an array
+    template <Accuracy A = Accuracy::MEDIUM, typename T>
+    void fastCos(const T* in, T* out, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+            out[i] = fastCos<A>(in[i]);
+    }
+    
+    //! Fast tangent approximation of an array
+    template <Accuracy A = Accuracy::MEDIUM, typename T>
+    void fastTan(const T* in, T* out, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+            out[i] = fastTan<A>(in[i]);
+    }
+    
+    //! Fast arc tangent approximation of an array
+    template <Accuracy A = Accuracy::MEDIUM, typename T>
+    void fastAtan(const T* in, T* out, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+            out[i] = fastAtan<A>(in[i]);
+    }
+    
+    //! Fast two-argument arc tangent approximation of two arrays
+    template <Accuracy A = Accuracy::MEDIUM, typename T>
+    void fastAtan2(const T* y, const T* x, T* out, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+            out[i] = fastAtan2<A>(y[i], x[i]);
+    }
+    
+    //! Fast exponential approximation of an array
+    template <Accuracy A = Accuracy::MEDIUM, typename T>
+    void fastExp(const T* in, T* out, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+            out[i] = fastExp<A>(in[i]);
+    }
+    
+    //! Fast natural logarithm approximation of an array
+    template <Accuracy A = Accuracy::MEDIUM, typename T>
+    void fastLog(const T* in, T* out, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+            out[i] = fastLog<A>(in[i]);
+    }
+    
+    //! Math policy that forwards to the standard library
+    /*! Functions like sigmoidTan() take a math policy as template argument, and functions like lin2log()
+        as optional last argument, so call sites can opt into the fast approximations using FastMath */
+    struct StandardMath
+    {
+        template <typename T> static auto sin(const T& x) { return std::sin(x); }
+        template <typename T> static auto cos(const T& x) { return std::cos(x); }
+        template <typename T> static auto tan(const T& x) { return std::tan(x); }
+        template <typename T> static auto atan(const T& x) { return std::atan(x); }
+        template <typename T> static auto atan2(const T& y, const T& x) { return std::atan2(y, x); }
+        template <typename T> static auto exp(const T& x) { return std::exp(x); }
+        template <typename T> static auto log(const T& x) { return std::log(x); }
+        template <typename T, typename U> static auto pow(const T& x, const U& y) { return std::pow(x, y); }
+    };
+    
+    //! Math policy that uses the fast approximations
+    /*! Integer arguments are computed in double */
+    template <Accuracy A = Accuracy::MEDIUM>
+    struct FastMath
+    {
+        template <typename T> using Float = std::conditional_t<std::is_floating_point<T>::value && !std::is_same<T, long double>::value, T, double>;
+        
+        template <typename T> static auto sin(const T& x) { return fastSin<A>(static_cast<Float<T>>(x)); }
+        template <typename T> static auto cos(const T& x) { return fastCos<A>(static_cast<Float<T>>(x)); }
+        template <typename T> static auto tan(const T& x) { return fastTan<A>(static_cast<Float<T>>(x)); }
+        template <typename T> static auto atan(const T& x) { return fastAtan<A>(static_cast<Float<T>>(x)); }
+        template <typename T> static auto atan2(const T& y, const T& x) { return fastAtan2<A>(static_cast<Float<T>>(y), static_cast<Float<T>>(x)); }
+        template <typename T> static auto exp(const T& x) { return fastExp<A>(static_cast<Float<T>>(x)); }
+        template <typename T> static auto log(const T& x) { return fastLog<A>(static_cast<Float<T>>(x)); }
+        
+        //! Computes exp(y * log(x)), so only defined for x >= 0
+        template <typename T, typename U> static auto pow(const T& x, const U& y) { return fastExp<A>(static_cast<Float<T>>(y) * fastLog<A>(static_cast<Float<T>>(x))); }
+    };
+}
+
+#endif
@@ -26,6 +26,7 @@ namespace math
     template <class T> constexpr T SQRT_FIVE = 2.23606797749978969640917366873127623; //!< The square root of 5
     
     template <class T> constexpr T EULER = 2.71828182845904523536028747135266249; //!< Euler's number
+    template <class T> constexpr T LN_TWO = 0.693147180559945309417232121458176568; //!< The natural logarithm of 2
     
     template <class T> constexpr T PHI = 1.61803398874989484820458683436563811; //!< The golden ratio
     template <class T> constexpr T INVERSE_PHI = T{1} / PHI<T>; //!< The golden ratio
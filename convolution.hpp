@@ -0,0 +1,320 @@
+//
+//  convolution.hpp
+//  Math
+//
+//  Copyright © 2015-2016 Dsperados (info@dsperados.com). All rights reserved.
+//  Licensed under the BSD 3-clause license.
+//
+
+#ifndef DSPERADOS_MATH_CONVOLUTION_HPP
+#define DSPERADOS_MATH_CONVOLUTION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "fft.hpp"
+#include "linear.hpp"
+#include "utility.hpp"
+
+namespace math
+{
+    //! Kernel size above which convolution switches from direct form to the FFT
+    /*! Below this size a vectorized dot product per output sample beats the transform overhead */
+    constexpr std::size_t FFT_CONVOLUTION_CROSSOVER = 64;
+    
+    //! Streaming finite impulse response filter
+    /*! Short kernels are computed in direct form, as one contiguous dot product per sample. Longer
+        kernels are split up: the first partition of taps is still computed in direct form, while
+        the remaining taps are convolved using uniformly partitioned overlap-save with a frequency
+        domain delay line. Output is identical to direct convolution, without any added latency.
+        
+        @code{cpp}
+        FirFilter<float> filter(kernel.begin(), kernel.end());
+        
+        filter.process(input.data(), output.data(), input.size());
+        @endcode */
+    template <class T>
+    class FirFilter
+    {
+    public:
+        //! Construct the filter from a kernel
+        /*! @param crossover The partition size, rounded up to a power of two. Kernels longer than
+                   one partition are convolved partly in the frequency domain
+            @throw std::invalid_argument if the kernel is empty or crossover == 0 */
+        template <class InputIterator>
+        FirFilter(InputIterator kernelBegin, InputIterator kernelEnd, std::size_t crossover = FFT_CONVOLUTION_CROSSOVER)
+        {
+            const std::vector<T> kernel(kernelBegin, kernelEnd);
+            if (kernel.empty())
+                throw std::invalid_argument("kernel is empty");
+            
+            if (crossover == 0)
+                throw std::invalid_argument("crossover == 0");
+            
+            // Kernels that fit in a single partition are computed in direct form only
+            const auto size = ceilToPowerOf2(crossover);
+            if (kernel.size() <= size)
+            {
+                setHead(kernel.begin(), kernel.end());
+                return;
+            }
+            
+            partitionSize = size;
+            setHead(kernel.begin(), kernel.begin() + partitionSize);
+            
+            fft = &getRealFft<T>(partitionSize * 2);
+            
+            // Transform each tail partition, zero-padded to twice its size
+            const auto partitionCount = (kernel.size() - 1) / partitionSize;
+            const auto bins = fft->binCount();
+            tailReal.resize(partitionCount * bins);
+            tailImag.resize(partitionCount * bins);
+            window.assign(partitionSize * 2, 0);
+            for (std::size_t p = 0; p < partitionCount; ++p)
+            {
+                const auto begin = (p + 1) * partitionSize;
+                const auto end = std::min(begin + partitionSize, kernel.size());
+                std::fill(window.begin(), window.end(), 0);
+                std::copy(kernel.begin() + begin, kernel.begin() + end, window.begin());
+                fft->forward(window.data(), &tailReal[p * bins], &tailImag[p * bins]);
+            }
+            
+            std::fill(window.begin(), window.end(), 0);
+            delayReal.assign(partitionCount * bins, 0);
+            delayImag.assign(partitionCount * bins, 0);
+            tailOutput.assign(partitionSize, 0);
+            accumulatedReal.resize(bins);
+            accumulatedImag.resize(bins);
+            scratch.resize(partitionSize * 2);
+        }
+        
+        //! Filter a single sample
+        T process(const T& x)
+        {
+            // Write the sample twice, so that the newest head.size() samples are always contiguous
+            history[historyIndex] = x;
+            history[historyIndex + head.size()] = x;
+            auto y = dot(&history[historyIndex + 1], head.data(), head.size());
+            if (++historyIndex == head.size())
+                historyIndex = 0;
+            
+            if (partitionSize == 0)
+                return y;
+            
+            y += tailOutput[blockIndex];
+            window[partitionSize + blockIndex] = x;
+            if (++blockIndex == partitionSize)
+                processBlock();
+            
+            return y;
+        }
+        
+        //! Filter a block of samples
+        /*! In-place processing (in == out) is allowed */
+        void process(const T* in, T* out, std::size_t size)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = process(in[i]);
+        }
+        
+        //! Clear the filter state
+        void reset()
+        {
+            std::fill(history.begin(), history.end(), 0);
+            std::fill(delayReal.begin(), delayReal.end(), 0);
+            std::fill(delayImag.begin(), delayImag.end(), 0);
+            std::fill(window.begin(), window.end(), 0);
+            std::fill(tailOutput.begin(), tailOutput.end(), 0);
+            historyIndex = 0;
+            blockIndex = 0;
+            delayIndex = 0;
+        }
+        
+        //! Is part of the kernel convolved in the frequency domain?
+        bool usesFft() const { return partitionSize != 0; }
+        
+    private:
+        //! Store the direct form taps reversed, so they line up with the history
+        template <class Iterator>
+        void setHead(Iterator begin, Iterator end)
+        {
+            head.assign(std::make_reverse_iterator(end), std::make_reverse_iterator(begin));
+            history.assign(head.size() * 2, 0);
+        }
+        
+        //! Transform a completed input block and compute the tail output for the next block
+        void processBlock()
+        {
+            const auto bins = fft->binCount();
+            const auto partitionCount = tailReal.size() / bins;
+            
+            // Transform the window of the previous and current block into the delay line
+            fft->forward(window.data(), &delayReal[delayIndex * bins], &delayImag[delayIndex * bins]);
+            
+            // Multiply-accumulate every partition with its matching input spectrum
+            std::fill(accumulatedReal.begin(), accumulatedReal.end(), 0);
+            std::fill(accumulatedImag.begin(), accumulatedImag.end(), 0);
+            for (std::size_t p = 0; p < partitionCount; ++p)
+            {
+                const auto offset = ((delayIndex + partitionCount - p) % partitionCount) * bins;
+                const auto hr = &tailReal[p * bins];
+                const auto hi = &tailImag[p * bins];
+                const auto xr = &delayReal[offset];
+                const auto xi = &delayImag[offset];
+                
+                for (std::size_t k = 0; k < bins; ++k)
+                {
+                    accumulatedReal[k] += hr[k] * xr[k] - hi[k] * xi[k];
+                    accumulatedImag[k] += hr[k] * xi[k] + hi[k] * xr[k];
+                }
+            }
+            
+            // The last half of the circular convolution is the valid overlap-save output
+            fft->inverse(accumulatedReal.data(), accumulatedImag.data(), scratch.data());
+            std::copy(scratch.begin() + partitionSize, scratch.end(), tailOutput.begin());
+            
+            std::copy(window.begin() + partitionSize, window.end(), window.begin());
+            delayIndex = (delayIndex + 1) % partitionCount;
+            blockIndex = 0;
+        }
+        
+    private:
+        //! The direct form taps, reversed
+        std::vector<T> head;
+        
+        //! The doubled circular input history for the direct form taps
+        std::vector<T> history;
+        
+        //! The write position in the history
+        std::size_t historyIndex = 0;
+        
+        //! The partition size, or 0 if the filter only uses direct form
+        std::size_t partitionSize = 0;
+        
+        //! The cached transform of twice the partition size, if part of the kernel is convolved in the frequency domain
+        const RealFft<T>* fft = nullptr;
+        
+        //! The split-complex spectra of the tail partitions, each zero-padded to twice the partition size
+        std::vector<T> tailReal;
+        std::vector<T> tailImag;
+        
+        //! The split-complex spectra of past input windows, as a circular buffer
+        std::vector<T> delayReal;
+        std::vector<T> delayImag;
+        
+        //! The index of the newest spectrum in the delay line
+        std::size_t delayIndex = 0;
+        
+        //! The previous and current input block
+        std::vector<T> window;
+        
+        //! The contribution of the tail partitions for the current block
+        std::vector<T> tailOutput;
+        
+        //! The position within the current block
+        std::size_t blockIndex = 0;
+        
+        //! The split-complex sum of all partition products
+        std::vector<T> accumulatedReal;
+        std::vector<T> accumulatedImag;
+        
+        //! The inverse transformed output of both blocks
+        std::vector<T> scratch;
+    };
+    
+    //! Convolve two ranges
+    /*! Writes the full linear convolution (size1 + size2 - 1 samples) to the output. Uses direct form
+        dot products when the smallest range is shorter than the crossover, otherwise the FFT.
+        @throw std::invalid_argument if either range is empty */
+    template <class InputIterator1, class InputIterator2, class OutputIterator>
+    OutputIterator convolve(InputIterator1 begin1, InputIterator1 end1, InputIterator2 begin2, InputIterator2 end2, OutputIterator outBegin, std::size_t crossover = FFT_CONVOLUTION_CROSSOVER)
+    {
+        using T = std::common_type_t<typename std::iterator_traits<InputIterator1>::value_type, typename std::iterator_traits<InputIterator2>::value_type>;
+        
+        std::vector<T> x(begin1, end1);
+        std::vector<T> h(begin2, end2);
+        if (x.empty() || h.empty())
+            throw std::invalid_argument("range is empty");
+        
+        if (x.size() < h.size())
+            std::swap(x, h);
+        
+        const auto size = x.size() + h.size() - 1;
+        
+        if (h.size() <= crossover)
+        {
+            // Pad the signal on both sides, so every output is a single contiguous dot product
+            std::vector<T> padded(x.size() + 2 * (h.size() - 1), 0);
+            std::copy(x.begin(), x.end(), padded.begin() + h.size() - 1);
+            std::reverse(h.begin(), h.end());
+            
+            for (std::size_t i = 0; i < size; ++i)
+                *outBegin++ = dot(&padded[i], h.data(), h.size());
+            
+            return outBegin;
+        }
+        
+        const auto& fft = getRealFft<T>(std::max<std::size_t>(ceilToPowerOf2(size), 2));
+        const auto bins = fft.binCount();
+        x.resize(fft.size(), 0);
+        h.resize(fft.size(), 0);
+        
+        std::vector<T> spectra(bins * 4);
+        T* xr = spectra.data();
+        T* xi = xr + bins;
+        T* hr = xi + bins;
+        T* hi = hr + bins;
+        fft.forward(x.data(), xr, xi);
+        fft.forward(h.data(), hr, hi);
+        
+        for (std::size_t k = 0; k < bins; ++k)
+        {
+            const auto re = xr[k] * hr[k] - xi[k] * hi[k];
+            const auto im = xr[k] * hi[k] + xi[k] * hr[k];
+            xr[k] = re;
+            xi[k] = im;
+        }
+        
+        fft.inverse(xr, xi, x.data());
+        
+        return std::copy(x.begin(), x.begin() + size, outBegin);
+    }
+    
+    //! Cross-correlate two ranges
+    /*! Writes size1 + size2 - 1 samples to the output, where output i is the correlation at lag
+        i - (size2 - 1), i.e. sum(x[n + lag] * y[n])
+        @throw std::invalid_argument if either range is empty */
+    template <class InputIterator1, class InputIterator2, class OutputIterator>
+    OutputIterator crossCorrelate(InputIterator1 begin1, InputIterator1 end1, InputIterator2 begin2, InputIterator2 end2, OutputIterator outBegin, std::size_t crossover = FFT_CONVOLUTION_CROSSOVER)
+    {
+        using T = typename std::iterator_traits<InputIterator2>::value_type;
+        
+        std::vector<T> reversed(begin2, end2);
+        std::reverse(reversed.begin(), reversed.end());
+        
+        return convolve(begin1, end1, reversed.begin(), reversed.end(), outBegin, crossover);
+    }
+    
+    //! Auto-correlate a range
+    /*! Writes the correlation at the non-negative lags 0 to size - 1 to the output
+        @throw std::invalid_argument if the range is empty */
+    template <class InputIterator, class OutputIterator>
+    OutputIterator autoCorrelate(InputIterator begin, InputIterator end, OutputIterator outBegin, std::size_t crossover = FFT_CONVOLUTION_CROSSOVER)
+    {
+        using T = typename std::iterator_traits<InputIterator>::value_type;
+        
+        const std::vector<T> x(begin, end);
+        if (x.empty())
+            throw std::invalid_argument("range is empty");
+        
+        std::vector<T> correlation(x.size() * 2 - 1);
+        crossCorrelate(x.begin(), x.end(), x.begin(), x.end(), correlation.begin(), crossover);
+        
+        return std::copy(correlation.begin() + x.size() - 1, correlation.end(), outBegin);
+    }
+}
+
+#endif
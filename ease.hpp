@@ -9,8 +9,13 @@
 #ifndef MATH_EASE_HPP
 #define MATH_EASE_HPP
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <stdexcept>
 
+#include "approximation.hpp"
+#include "constants.hpp"
 #include "interpolation.hpp"
 
 namespace math
@@ -23,17 +28,298 @@ namespace math
     }
     
     //! Ease using cosine interpolation
+    template <class T, class Math = StandardMath>
+    T easeCosine(const T& index)
+    {
+        return static_cast<T>(interpolateCosine<T, T, Math>(index, T{0}, T{1}));
+    }
+    
+    //! Ease in using a quarter circle
+    template <class T>
+    T easeCircular(const T& index)
+    {
+        return 1 - std::sqrt(std::max<T>(1 - index * index, 0));
+    }
+    
+    //! Ease out using a quarter circle
     template <class T>
-    constexpr T easeCosine(const T& index)
+    T easeOutCircular(const T& index)
     {
-        return interpolateCosine<T>(index, 0, 1);
+        return std::sqrt(std::max<T>(1 - (index - 1) * (index - 1), 0));
     }
     
-    //! Ease using
+    //! Ease in and out using two quarter circles
     template <class T>
-    constexpr T easeCircular(const T& index)
+    T easeInOutCircular(const T& index)
+    {
+        const T in = 2 * index;
+        const T out = 2 - 2 * index;
+        const T first = (1 - std::sqrt(std::max<T>(1 - in * in, 0))) / 2;
+        const T second = (1 + std::sqrt(std::max<T>(1 - out * out, 0))) / 2;
+        return index < T{0.5} ? first : second;
+    }
+    
+    //! Ease in using a power of the index
+    template <std::size_t N, class T>
+    constexpr T easeInPower(const T& index)
+    {
+        T result = index;
+        for (std::size_t i = 1; i < N; ++i)
+            result *= index;
+        
+        return result;
+    }
+    
+    //! Ease out using a power of the index
+    template <std::size_t N, class T>
+    constexpr T easeOutPower(const T& index)
+    {
+        return 1 - easeInPower<N>(1 - index);
+    }
+    
+    //! Ease in and out using a power of the index
+    template <std::size_t N, class T>
+    constexpr T easeInOutPower(const T& index)
+    {
+        const T first = easeInPower<N>(2 * index) / 2;
+        const T second = 1 - easeInPower<N>(2 - 2 * index) / 2;
+        return index < T{0.5} ? first : second;
+    }
+    
+    //! Ease in using a square
+    template <class T> constexpr T easeInQuad(const T& index) { return easeInPower<2>(index); }
+    
+    //! Ease out using a square
+    template <class T> constexpr T easeOutQuad(const T& index) { return easeOutPower<2>(index); }
+    
+    //! Ease in and out using a square
+    template <class T> constexpr T easeInOutQuad(const T& index) { return easeInOutPower<2>(index); }
+    
+    //! Ease in using a cube
+    template <class T> constexpr T easeInCubic(const T& index) { return easeInPower<3>(index); }
+    
+    //! Ease out using a cube
+    template <class T> constexpr T easeOutCubic(const T& index) { return easeOutPower<3>(index); }
+    
+    //! Ease in and out using a cube
+    template <class T> constexpr T easeInOutCubic(const T& index) { return easeInOutPower<3>(index); }
+    
+    //! Ease in using a fourth power
+    template <class T> constexpr T easeInQuart(const T& index) { return easeInPower<4>(index); }
+    
+    //! Ease out using a fourth power
+    template <class T> constexpr T easeOutQuart(const T& index) { return easeOutPower<4>(index); }
+    
+    //! Ease in and out using a fourth power
+    template <class T> constexpr T easeInOutQuart(const T& index) { return easeInOutPower<4>(index); }
+    
+    //! Ease in using a fifth power
+    template <class T> constexpr T easeInQuint(const T& index) { return easeInPower<5>(index); }
+    
+    //! Ease out using a fifth power
+    template <class T> constexpr T easeOutQuint(const T& index) { return easeOutPower<5>(index); }
+    
+    //! Ease in and out using a fifth power
+    template <class T> constexpr T easeInOutQuint(const T& index) { return easeInOutPower<5>(index); }
+    
+    //! Ease in exponentially, from 2^-10 at the start, snapped to 0
+    template <class T, class Math = StandardMath>
+    T easeInExponential(const T& index)
+    {
+        const auto result = static_cast<T>(Math::exp((10 * index - 10) * LN_TWO<T>));
+        return index <= 0 ? T{0} : result;
+    }
+    
+    //! Ease out exponentially, to 1 - 2^-10 at the end, snapped to 1
+    template <class T, class Math = StandardMath>
+    T easeOutExponential(const T& index)
+    {
+        const auto result = 1 - static_cast<T>(Math::exp(-10 * index * LN_TWO<T>));
+        return index >= 1 ? T{1} : result;
+    }
+    
+    //! Ease in and out exponentially, snapped to 0 and 1 at the ends
+    template <class T, class Math = StandardMath>
+    T easeInOutExponential(const T& index)
+    {
+        // Both halves share one exponential, mirrored around the center
+        const T exponent = (index < T{0.5} ? 20 * index - 10 : 10 - 20 * index) * LN_TWO<T>;
+        const auto power = static_cast<T>(Math::exp(exponent)) / 2;
+        const T result = index < T{0.5} ? power : 1 - power;
+        return index <= 0 ? T{0} : index >= 1 ? T{1} : result;
+    }
+    
+    //! The overshoot of the back easing functions, overshooting by 10%
+    constexpr double EASE_BACK_OVERSHOOT = 1.70158;
+    
+    //! Ease in, first pulling back below 0
+    template <class T>
+    constexpr T easeInBack(const T& index)
+    {
+        const auto c = static_cast<T>(EASE_BACK_OVERSHOOT);
+        return index * index * ((c + 1) * index - c);
+    }
+    
+    //! Ease out, overshooting beyond 1 before settling
+    template <class T>
+    constexpr T easeOutBack(const T& index)
+    {
+        return 1 - easeInBack<T>(1 - index);
+    }
+    
+    //! Ease in and out, pulling back at the start and overshooting at the end
+    template <class T>
+    constexpr T easeInOutBack(const T& index)
+    {
+        const auto c = static_cast<T>(EASE_BACK_OVERSHOOT * 1.525);
+        const T in = 2 * index;
+        const T out = 2 - 2 * index;
+        const T first = in * in * ((c + 1) * in - c) / 2;
+        const T second = 1 - out * out * ((c + 1) * out - c) / 2;
+        return index < T{0.5} ? first : second;
+    }
+    
+    //! Ease in with a growing oscillation, like a plucked elastic band
+    template <class T, class Math = StandardMath>
+    T easeInElastic(const T& index)
+    {
+        const auto envelope = static_cast<T>(Math::exp((10 * index - 10) * LN_TWO<T>));
+        const auto result = -envelope * static_cast<T>(Math::sin((10 * index - T{10.75}) * static_cast<T>(TAU<double> / 3)));
+        return index <= 0 ? T{0} : index >= 1 ? T{1} : result;
+    }
+    
+    //! Ease out with a decaying oscillation, like a released elastic band
+    template <class T, class Math = StandardMath>
+    T easeOutElastic(const T& index)
+    {
+        const auto envelope = static_cast<T>(Math::exp(-10 * index * LN_TWO<T>));
+        const auto result = envelope * static_cast<T>(Math::sin((10 * index - T{0.75}) * static_cast<T>(TAU<double> / 3))) + 1;
+        return index <= 0 ? T{0} : index >= 1 ? T{1} : result;
+    }
+    
+    //! Ease in and out with an oscillation growing towards, and decaying from, the center
+    template <class T, class Math = StandardMath>
+    T easeInOutElastic(const T& index)
+    {
+        // Both halves share one envelope, mirrored around the center
+        const T exponent = (index < T{0.5} ? 20 * index - 10 : 10 - 20 * index) * LN_TWO<T>;
+        const auto envelope = static_cast<T>(Math::exp(exponent)) / 2;
+        const auto oscillation = envelope * static_cast<T>(Math::sin((20 * index - T{11.125}) * static_cast<T>(TAU<double> / 4.5)));
+        const T result = index < T{0.5} ? -oscillation : oscillation + 1;
+        return index <= 0 ? T{0} : index >= 1 ? T{1} : result;
+    }
+    
+    //! Ease out like a ball bouncing to rest
+    /*! Four parabolas of decreasing height, each evaluated so the one in range can be selected */
+    template <class T>
+    constexpr T easeOutBounce(const T& index)
+    {
+        const T n = 7.5625;
+        const T d = 2.75;
+        const T a = index - T{1.5} / d;
+        const T b = index - T{2.25} / d;
+        const T c = index - T{2.625} / d;
+        
+        const T first = n * index * index;
+        const T second = n * a * a + T{0.75};
+        const T third = n * b * b + T{0.9375};
+        const T fourth = n * c * c + T{0.984375};
+        
+        return index < 1 / d ? first : index < 2 / d ? second : index < T{2.5} / d ? third : fourth;
+    }
+    
+    //! Ease in like a bouncing ball reversed in time
+    template <class T>
+    constexpr T easeInBounce(const T& index)
+    {
+        return 1 - easeOutBounce<T>(1 - index);
+    }
+    
+    //! Ease in and out with bounces at both ends
+    template <class T>
+    constexpr T easeInOutBounce(const T& index)
+    {
+        // Both halves share one bounce, mirrored around the center
+        const T bounce = easeOutBounce<T>(index < T{0.5} ? 1 - 2 * index : 2 * index - 1) / 2;
+        return index < T{0.5} ? T{0.5} - bounce : T{0.5} + bounce;
+    }
+    
+    //! The easing curves available to the block version of ease()
+    enum class EaseCurve
+    {
+        LINEAR,
+        COSINE,
+        IN_QUAD, OUT_QUAD, IN_OUT_QUAD,
+        IN_CUBIC, OUT_CUBIC, IN_OUT_CUBIC,
+        IN_QUART, OUT_QUART, IN_OUT_QUART,
+        IN_QUINT, OUT_QUINT, IN_OUT_QUINT,
+        IN_EXPONENTIAL, OUT_EXPONENTIAL, IN_OUT_EXPONENTIAL,
+        IN_CIRCULAR, OUT_CIRCULAR, IN_OUT_CIRCULAR,
+        IN_BACK, OUT_BACK, IN_OUT_BACK,
+        IN_ELASTIC, OUT_ELASTIC, IN_OUT_ELASTIC,
+        IN_BOUNCE, OUT_BOUNCE, IN_OUT_BOUNCE
+    };
+    
+    //! Evaluate an easing function for a block of evenly spaced indices
+    /*! Index i is tBegin + i * (tEnd - tBegin) / size, so consecutive blocks continue where the
+        previous one stopped, and tEnd itself is the first index of the next block */
+    template <class T, class Function>
+    void ease(Function function, const T& tBegin, const T& tEnd, T* out, std::size_t size)
+    {
+        // Copy the range, as the output might alias it
+        const T start = tBegin;
+        const T step = size > 0 ? (tEnd - tBegin) / static_cast<T>(size) : T{0};
+        for (std::size_t i = 0; i < size; ++i)
+            out[i] = function(start + static_cast<T>(i) * step);
+    }
+    
+    //! Evaluate an easing curve for a block of evenly spaced indices
+    /*! The curve is resolved once per block, so the loop itself only contains the curve
+        @tparam Math The math policy for the exponential, elastic and cosine curves, use FastMath to have those vectorize too
+        @throw std::invalid_argument for an unknown curve
+        
+        @code{cpp}
+        // Glide the first half of an automation ramp into one block, the second half into the next
+        ease(EaseCurve::IN_OUT_CUBIC, 0.f, 0.5f, block.data(), block.size());
+        ease(EaseCurve::IN_OUT_CUBIC, 0.5f, 1.f, block.data(), block.size());
+        @endcode */
+    template <class T, class Math = StandardMath>
+    void ease(EaseCurve curve, const T& tBegin, const T& tEnd, T* out, std::size_t size)
     {
-        return 1 - std::sqrt(1 - (index * index));
+        switch (curve)
+        {
+            case EaseCurve::LINEAR: return ease([](const T& t){ return easeLinear<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::COSINE: return ease([](const T& t){ return easeCosine<T, Math>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_QUAD: return ease([](const T& t){ return easeInQuad<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::OUT_QUAD: return ease([](const T& t){ return easeOutQuad<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_OUT_QUAD: return ease([](const T& t){ return easeInOutQuad<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_CUBIC: return ease([](const T& t){ return easeInCubic<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::OUT_CUBIC: return ease([](const T& t){ return easeOutCubic<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_OUT_CUBIC: return ease([](const T& t){ return easeInOutCubic<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_QUART: return ease([](const T& t){ return easeInQuart<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::OUT_QUART: return ease([](const T& t){ return easeOutQuart<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_OUT_QUART: return ease([](const T& t){ return easeInOutQuart<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_QUINT: return ease([](const T& t){ return easeInQuint<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::OUT_QUINT: return ease([](const T& t){ return easeOutQuint<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_OUT_QUINT: return ease([](const T& t){ return easeInOutQuint<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_EXPONENTIAL: return ease([](const T& t){ return easeInExponential<T, Math>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::OUT_EXPONENTIAL: return ease([](const T& t){ return easeOutExponential<T, Math>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_OUT_EXPONENTIAL: return ease([](const T& t){ return easeInOutExponential<T, Math>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_CIRCULAR: return ease([](const T& t){ return easeCircular<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::OUT_CIRCULAR: return ease([](const T& t){ return easeOutCircular<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_OUT_CIRCULAR: return ease([](const T& t){ return easeInOutCircular<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_BACK: return ease([](const T& t){ return easeInBack<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::OUT_BACK: return ease([](const T& t){ return easeOutBack<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_OUT_BACK: return ease([](const T& t){ return easeInOutBack<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_ELASTIC: return ease([](const T& t){ return easeInElastic<T, Math>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::OUT_ELASTIC: return ease([](const T& t){ return easeOutElastic<T, Math>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_OUT_ELASTIC: return ease([](const T& t){ return easeInOutElastic<T, Math>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_BOUNCE: return ease([](const T& t){ return easeInBounce<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::OUT_BOUNCE: return ease([](const T& t){ return easeOutBounce<T>(t); }, tBegin, tEnd, out, size);
+            case EaseCurve::IN_OUT_BOUNCE: return ease([](const T& t){ return easeInOutBounce<T>(t); }, tBegin, tEnd, out, size);
+        }
+        
+        throw std::invalid_argument("unknown ease curve");
     }
 }
 
@@ -0,0 +1,413 @@
+//
+//  envelope.hpp
+//  Math
+//
+//  Copyright © 2015-2016 Dsperados (info@dsperados.com). All rights reserved.
+//  Licensed under the BSD 3-clause license.
+//
+
+#ifndef DSPERADOS_MATH_ENVELOPE_HPP
+#define DSPERADOS_MATH_ENVELOPE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "approximation.hpp"
+#include "ease.hpp"
+
+namespace math
+{
+    //! The curve of a segment of a breakpoint envelope
+    enum class EnvelopeCurve
+    {
+        LINEAR,
+        EXPONENTIAL,
+        EASE,
+        CUBIC
+    };
+    
+    //! Envelope made of segments, each moving to a level in a number of samples along a curve
+    /*! The envelope describes the shape only, and can be shared between any number of voices. Each
+        voice keeps its own small state in a BreakpointEnvelope::Voice, and is rendered a block at a
+        time. Within a segment every curve is evaluated in closed form from the number of samples done,
+        so the error doesn't accumulate over long segments, and rendering never searches for the
+        segment a sample belongs to.
+        
+        An optional sustain loop repeats a range of segments for as long as the gate is held, or holds
+        at a breakpoint if the range is empty. Releasing the gate continues with the segment after the
+        loop, starting from wherever the voice is at that moment.
+        
+        @code{cpp}
+        // ADSR, sustaining at 0.5
+        BreakpointEnvelope<float> adsr;
+        adsr.addLinear(1, 480);
+        adsr.addExponential(0.5, 4800, 4);
+        adsr.addExponential(0, 9600, 4);
+        adsr.setSustainLoop(2, 2);
+        
+        BreakpointEnvelope<float>::Voice voice;
+        adsr.reset(voice);
+        adsr.trigger(voice);
+        adsr.process(voice, block.data(), block.size());
+        @endcode */
+    template <typename T, class Math = StandardMath>
+    class BreakpointEnvelope
+    {
+    public:
+        //! The state of a single voice playing the envelope
+        struct Voice
+        {
+            //! The segment being played, and the number of samples of it done
+            std::size_t segment = 0;
+            std::size_t position = 0;
+            
+            //! The current output, and the output at the start of the segment
+            T value = 0;
+            T start = 0;
+            
+            //! The coefficients of the segment: the step of a linear curve, the anchor of an exponential
+            //! curve, or the polynomial coefficients of a cubic curve
+            T coefficients[3] = {0, 0, 0};
+            
+            //! Is the gate held?
+            bool gate = false;
+            
+            //! Is the voice moving through a segment, or holding its value?
+            bool running = false;
+        };
+        
+    public:
+        //! Construct an envelope without segments, starting out at a level
+        BreakpointEnvelope(const T& initial = 0) :
+            initial(initial)
+        {
+        
+        }
+        
+        //! Add a segment moving linearly to a level
+        /*! @throw std::invalid_argument if length == 0 */
+        void addLinear(const T& level, std::size_t length)
+        {
+            add(level, length, EnvelopeCurve::LINEAR);
+        }
+        
+        //! Add a segment moving exponentially to a level
+        /*! @param curvature How far the curve bends, the ratio between the steepest and shallowest
+                   slope being e^|curvature|. Positive curvatures start out fast, like a one-pole
+                   filter, negative ones start out slow. Near 0, the segment is linear.
+            @throw std::invalid_argument if length == 0 */
+        void addExponential(const T& level, std::size_t length, double curvature)
+        {
+            auto& segment = add(level, length, std::abs(curvature) < 1e-3 ? EnvelopeCurve::LINEAR : EnvelopeCurve::EXPONENTIAL);
+            segment.rate = -curvature / length;
+            segment.residue = std::exp(-curvature);
+        }
+        
+        //! Add a segment moving to a level along an easing curve
+        /*! @throw std::invalid_argument if length == 0 */
+        void addEase(const T& level, std::size_t length, EaseCurve curve)
+        {
+            add(level, length, EnvelopeCurve::EASE).ease = curve;
+        }
+        
+        //! Add a segment moving to a level along a Catmull-Rom spline through the breakpoints
+        /*! The slope at every breakpoint is taken from its neighbouring breakpoints, and is flat at
+            the first and last breakpoint, so successive cubic segments join smoothly
+            @throw std::invalid_argument if length == 0 */
+        void addCubic(const T& level, std::size_t length)
+        {
+            add(level, length, EnvelopeCurve::CUBIC);
+        }
+        
+        //! Remove all segments and the sustain loop
+        void clear()
+        {
+            segments.clear();
+            loopBegin = loopEnd = NO_LOOP;
+        }
+        
+        //! Repeat the segments in [begin, end) while the gate is held
+        /*! If begin equals end, the envelope holds at the level reached after segment begin - 1
+            @throw std::invalid_argument if begin > end or end > the number of segments */
+        void setSustainLoop(std::size_t begin, std::size_t end)
+        {
+            if (begin > end || end > segments.size())
+                throw std::invalid_argument("sustain loop out of range");
+            
+            loopBegin = begin;
+            loopEnd = end;
+        }
+        
+        //! Remove the sustain loop, so the envelope plays as a one-shot
+        void removeSustainLoop()
+        {
+            loopBegin = loopEnd = NO_LOOP;
+        }
+        
+        //! Start a voice at the first segment, holding the gate
+        /*! A retriggered voice moves on from its current value, so it doesn't click. Use reset() first
+            to start a new voice from the initial level. */
+        void trigger(Voice& voice) const
+        {
+            voice.gate = true;
+            enter(voice, 0);
+        }
+        
+        //! Release the gate of a voice, moving it out of the sustain loop
+        void release(Voice& voice) const
+        {
+            if (!voice.gate)
+                return;
+            
+            const bool sustaining = isSustaining(voice);
+            voice.gate = false;
+            if (loopEnd != NO_LOOP && (voice.segment < loopEnd || sustaining))
+                enter(voice, loopEnd);
+        }
+        
+        //! Put a voice back at the initial level, idle
+        void reset(Voice& voice) const
+        {
+            voice = Voice();
+            voice.value = voice.start = initial;
+        }
+        
+        //! Render the next block of a voice
+        void process(Voice& voice, T* out, std::size_t size) const
+        {
+            while (size > 0)
+            {
+                if (!voice.running)
+                {
+                    std::fill(out, out + size, voice.value);
+                    return;
+                }
+                
+                const auto& segment = segments[voice.segment];
+                const auto count = std::min(size, segment.length - voice.position);
+                render(voice, segment, out, count);
+                
+                out += count;
+                size -= count;
+                voice.position += count;
+                
+                // Land exactly on the breakpoint, and move on
+                if (voice.position == segment.length)
+                {
+                    voice.value = segment.level;
+                    advance(voice);
+                }
+            }
+        }
+        
+        //! Is the voice moving through a segment, rather than sustaining or finished?
+        bool isRunning(const Voice& voice) const { return voice.running; }
+        
+        //! Is the voice holding at an empty sustain loop?
+        bool isSustaining(const Voice& voice) const { return !voice.running && voice.gate && voice.segment == loopBegin && loopBegin == loopEnd; }
+        
+        //! Has the voice played its last segment, or was it never triggered?
+        bool isFinished(const Voice& voice) const { return !voice.running && !isSustaining(voice); }
+        
+        //! The number of segments
+        std::size_t size() const { return segments.size(); }
+        
+        //! The initial level
+        T getInitial() const { return initial; }
+        
+    private:
+        //! A segment, including the values precomputed for its curve
+        struct Segment
+        {
+            T level = 0;
+            std::size_t length = 0;
+            EnvelopeCurve curve = EnvelopeCurve::LINEAR;
+            EaseCurve ease = EaseCurve::LINEAR;
+            
+            //! The logarithm of the ratio per sample, and the ratio over the whole segment, of an exponential curve
+            double rate = 0;
+            double residue = 1;
+            
+            //! The slopes at the start and end of a cubic curve, per sample
+            T startSlope = 0;
+            T endSlope = 0;
+        };
+        
+        //! Marks the absence of a sustain loop
+        static constexpr std::size_t NO_LOOP = static_cast<std::size_t>(-1);
+        
+    private:
+        //! Append a segment and update the spline slopes
+        Segment& add(const T& level, std::size_t length, EnvelopeCurve curve)
+        {
+            if (length == 0)
+                throw std::invalid_argument("length == 0");
+            
+            Segment segment;
+            segment.level = level;
+            segment.length = length;
+            segment.curve = curve;
+            segments.emplace_back(segment);
+            
+            // The new breakpoint changes the slope at the end of the segment before it
+            for (std::size_t i = segments.size() >= 2 ? segments.size() - 2 : 0; i < segments.size(); ++i)
+            {
+                segments[i].startSlope = slope(i);
+                segments[i].endSlope = slope(i + 1);
+            }
+            
+            return segments.back();
+        }
+        
+        //! The level at a breakpoint, breakpoint 0 being the initial level
+        T breakpoint(std::size_t index) const
+        {
+            return index == 0 ? initial : segments[index - 1].level;
+        }
+        
+        //! The Catmull-Rom slope at a breakpoint, flat at both ends
+        T slope(std::size_t index) const
+        {
+            if (index == 0 || index >= segments.size())
+                return 0;
+            
+            const auto span = static_cast<T>(segments[index - 1].length + segments[index].length);
+            return (breakpoint(index + 1) - breakpoint(index - 1)) / span;
+        }
+        
+        //! Move a voice on to the next segment, looping or holding as needed
+        void advance(Voice& voice) const
+        {
+            auto next = voice.segment + 1;
+            if (voice.gate && next == loopEnd)
+                next = loopBegin;
+            
+            enter(voice, next);
+        }
+        
+        //! Start a segment from the current value, and set up its coefficients
+        void enter(Voice& voice, std::size_t index) const
+        {
+            voice.segment = index;
+            voice.position = 0;
+            voice.start = voice.value;
+            
+            // Hold at an empty sustain loop, or stop after the last segment
+            const bool holding = voice.gate && index == loopBegin && loopBegin == loopEnd;
+            voice.running = !holding && index < segments.size();
+            if (!voice.running)
+                return;
+            
+            const auto& segment = segments[index];
+            const auto length = static_cast<T>(segment.length);
+            const auto distance = segment.level - voice.start;
+            switch (segment.curve)
+            {
+                case EnvelopeCurve::LINEAR:
+                    voice.coefficients[0] = distance / length;
+                    break;
+                case EnvelopeCurve::EXPONENTIAL:
+                    // value = anchor + (start - anchor) * e^(rate n), reaching the level at n = length
+                    voice.coefficients[0] = static_cast<T>((segment.level - voice.start * segment.residue) / (1 - segment.residue));
+                    break;
+                case EnvelopeCurve::EASE:
+                    break;
+                case EnvelopeCurve::CUBIC:
+                {
+                    // value = start + b t + c t^2 + d t^3 with t = n / length, as a Hermite curve with the spline slopes
+                    const auto startSlope = segment.startSlope * length;
+                    const auto endSlope = segment.endSlope * length;
+                    voice.coefficients[0] = startSlope;
+                    voice.coefficients[1] = 3 * distance - 2 * startSlope - endSlope;
+                    voice.coefficients[2] = startSlope + endSlope - 2 * distance;
+                    break;
+                }
+            }
+        }
+        
+        //! Render a number of samples of the current segment
+        void render(Voice& voice, const Segment& segment, T* out, std::size_t count) const
+        {
+            auto value = voice.value;
+            switch (segment.curve)
+            {
+                case EnvelopeCurve::LINEAR:
+                {
+                    // Computed from the start of the segment, so the error doesn't accumulate
+                    const auto start = voice.start;
+                    const auto step = voice.coefficients[0];
+                    const auto first = static_cast<T>(voice.position + 1);
+                    for (std::size_t i = 0; i < count; ++i)
+                        out[i] = start + (first + static_cast<T>(i)) * step;
+                    
+                    value = out[count - 1];
+                    break;
+                }
+                case EnvelopeCurve::EXPONENTIAL:
+                {
+                    // Computed from the start of the segment in double, so long segments don't drift
+                    const auto anchor = static_cast<double>(voice.coefficients[0]);
+                    const auto distance = static_cast<double>(voice.start) - anchor;
+                    const auto rate = segment.rate;
+                    const auto first = static_cast<double>(voice.position + 1);
+                    for (std::size_t i = 0; i < count; ++i)
+                        out[i] = static_cast<T>(anchor + distance * Math::exp((first + static_cast<double>(i)) * rate));
+                    
+                    value = out[count - 1];
+                    break;
+                }
+                case EnvelopeCurve::EASE:
+                {
+                    const auto length = static_cast<T>(segment.length);
+                    const auto begin = static_cast<T>(voice.position + 1) / length;
+                    const auto end = static_cast<T>(voice.position + 1 + count) / length;
+                    ease<T, Math>(segment.ease, begin, end, out, count);
+                    
+                    const auto start = voice.start;
+                    const auto distance = segment.level - start;
+                    for (std::size_t i = 0; i < count; ++i)
+                        out[i] = start + distance * out[i];
+                    
+                    value = out[count - 1];
+                    break;
+                }
+                case EnvelopeCurve::CUBIC:
+                {
+                    // Computed from the start of the segment, so the error doesn't accumulate
+                    const auto start = voice.start;
+                    const auto b = voice.coefficients[0];
+                    const auto c = voice.coefficients[1];
+                    const auto d = voice.coefficients[2];
+                    const auto length = static_cast<T>(segment.length);
+                    const auto first = static_cast<T>(voice.position + 1);
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        const auto t = (first + static_cast<T>(i)) / length;
+                        out[i] = start + t * (b + t * (c + t * d));
+                    }
+                    
+                    value = out[count - 1];
+                    break;
+                }
+            }
+            
+            voice.value = value;
+        }
+        
+    private:
+        //! The segments
+        std::vector<Segment> segments;
+        
+        //! The level before the first segment
+        T initial = 0;
+        
+        //! The sustain loop
+        std::size_t loopBegin = NO_LOOP;
+        std::size_t loopEnd = NO_LOOP;
+    };
+}
+
+#endif
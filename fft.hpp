@@ -0,0 +1,577 @@
+//
+//  fft.hpp
+//  Math
+//
+//  Copyright © 2015-2016 Dsperados (info@dsperados.com). All rights reserved.
+//  Licensed under the BSD 3-clause license.
+//
+
+#ifndef DSPERADOS_MATH_FFT_HPP
+#define DSPERADOS_MATH_FFT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "constants.hpp"
+#include "interleave.hpp"
+
+namespace math
+{
+    //! Mixed-radix complex fast Fourier transform
+    /*! Precomputes the factorization and twiddle factors for a given size, so that repeated
+        transforms of that size don't pay any setup cost. The size is factored into radix-4 and
+        radix-2 stages first, remaining odd factors use a generic butterfly.
+        
+        The transform runs as a Stockham autosort on split real and imaginary arrays, so no
+        bit-reversal pass is needed and the butterflies operate on contiguous memory. Interleaved
+        std::complex buffers are converted to and from the split layout internally.
+        
+        @code{cpp}
+        const auto& fft = getFft<float>(1024);
+        
+        std::vector<std::complex<float>> data(1024);
+        fft.forward(data.data());
+        fft.inverse(data.data());
+        @endcode */
+    template <class T>
+    class Fft
+    {
+    public:
+        //! Construct the transform for a given size
+        /*! @throw std::invalid_argument if size == 0 */
+        Fft(std::size_t size) :
+            n(size)
+        {
+            if (size == 0)
+                throw std::invalid_argument("size == 0");
+            
+            // Factor into as many radix-4 stages as possible, then radix-2, then the odd factors
+            std::vector<std::size_t> radices;
+            auto remainder = size;
+            while (remainder % 4 == 0)
+            {
+                radices.emplace_back(4);
+                remainder /= 4;
+            }
+            
+            if (remainder % 2 == 0)
+            {
+                radices.emplace_back(2);
+                remainder /= 2;
+            }
+            
+            for (std::size_t factor = 3; remainder > 1; factor += 2)
+            {
+                while (remainder % factor == 0)
+                {
+                    radices.emplace_back(factor);
+                    remainder /= factor;
+                }
+                
+                if (factor * factor > remainder && remainder > 1)
+                {
+                    radices.emplace_back(remainder);
+                    remainder = 1;
+                }
+            }
+            
+            // Precompute the twiddles w^(p * k) of each stage, where w = e^(-2πi / length)
+            std::size_t length = size;
+            std::size_t stride = 1;
+            for (auto radix : radices)
+            {
+                Stage stage;
+                stage.radix = radix;
+                stage.m = length / radix;
+                stage.stride = stride;
+                stage.cos.resize(stage.m * (radix - 1));
+                stage.sin.resize(stage.m * (radix - 1));
+                
+                for (std::size_t k = 1; k < radix; ++k)
+                {
+                    for (std::size_t p = 0; p < stage.m; ++p)
+                    {
+                        const auto angle = -TWO_PI<double> * static_cast<double>((p * k) % length) / length;
+                        stage.cos[(k - 1) * stage.m + p] = std::cos(angle);
+                        stage.sin[(k - 1) * stage.m + p] = std::sin(angle);
+                    }
+                }
+                
+                // Generic butterflies need the radix' own roots of unity
+                if (radix != 2 && radix != 4)
+                {
+                    stage.rootCos.resize(radix);
+                    stage.rootSin.resize(radix);
+                    for (std::size_t j = 0; j < radix; ++j)
+                    {
+                        stage.rootCos[j] = std::cos(-TWO_PI<double> * j / radix);
+                        stage.rootSin[j] = std::sin(-TWO_PI<double> * j / radix);
+                    }
+                }
+                
+                stages.emplace_back(std::move(stage));
+                length /= radix;
+                stride *= radix;
+            }
+        }
+        
+        //! Apply the forward transform to a split-complex buffer in-place
+        void forward(T* real, T* imag) const
+        {
+            forward(real, imag, real, imag);
+        }
+        
+        //! Apply the forward transform to a split-complex buffer out-of-place
+        /*! The input and output may alias */
+        void forward(const T* realIn, const T* imagIn, T* realOut, T* imagOut) const
+        {
+            static thread_local std::vector<T> work;
+            if (work.size() < n * 2)
+                work.resize(n * 2);
+            
+            // Ping-pong between the output and the work buffer, so the last stage lands in the output
+            const bool even = stages.size() % 2 == 0;
+            T* xr = even ? realOut : work.data();
+            T* xi = even ? imagOut : work.data() + n;
+            T* yr = even ? work.data() : realOut;
+            T* yi = even ? work.data() + n : imagOut;
+            
+            if (xr != realIn)
+                std::copy(realIn, realIn + n, xr);
+            
+            if (xi != imagIn)
+                std::copy(imagIn, imagIn + n, xi);
+            
+            for (auto& stage : stages)
+            {
+                switch (stage.radix)
+                {
+                    case 2: butterfly2(stage, xr, xi, yr, yi); break;
+                    case 4: butterfly4(stage, xr, xi, yr, yi); break;
+                    default: butterfly(stage, xr, xi, yr, yi); break;
+                }
+                
+                std::swap(xr, yr);
+                std::swap(xi, yi);
+            }
+        }
+        
+        //! Apply the inverse transform to a split-complex buffer in-place
+        /*! The output is scaled by 1 / size, so that inverse(forward(x)) == x */
+        void inverse(T* real, T* imag) const
+        {
+            inverse(real, imag, real, imag);
+        }
+        
+        //! Apply the inverse transform to a split-complex buffer out-of-place
+        /*! The output is scaled by 1 / size, so that inverse(forward(x)) == x. The input and output may alias */
+        void inverse(const T* realIn, const T* imagIn, T* realOut, T* imagOut) const
+        {
+            // Swapping the real and imaginary parts on both ends turns the forward into the inverse transform
+            forward(imagIn, realIn, imagOut, realOut);
+            
+            const T factor = T{1} / n;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                realOut[i] *= factor;
+                imagOut[i] *= factor;
+            }
+        }
+        
+        //! Apply the forward transform to an interleaved buffer in-place
+        void forward(std::complex<T>* data) const
+        {
+            forward(data, data);
+        }
+        
+        //! Apply the forward transform to an interleaved buffer out-of-place
+        void forward(const std::complex<T>* in, std::complex<T>* out) const
+        {
+            transformInterleaved(in, out, false);
+        }
+        
+        //! Apply the inverse transform to an interleaved buffer in-place
+        /*! The output is scaled by 1 / size, so that inverse(forward(x)) == x */
+        void inverse(std::complex<T>* data) const
+        {
+            inverse(data, data);
+        }
+        
+        //! Apply the inverse transform to an interleaved buffer out-of-place
+        /*! The output is scaled by 1 / size, so that inverse(forward(x)) == x */
+        void inverse(const std::complex<T>* in, std::complex<T>* out) const
+        {
+            transformInterleaved(in, out, true);
+        }
+        
+        //! The number of points in the transform
+        std::size_t size() const { return n; }
+        
+    private:
+        //! A single Stockham pass
+        struct Stage
+        {
+            std::size_t radix = 0; //!< The butterfly size
+            std::size_t m = 0; //!< The sub-transform length divided by the radix
+            std::size_t stride = 0; //!< The product of all previous radices
+            
+            std::vector<T> cos; //!< Real parts of the twiddles, indexed by (k - 1) * m + p
+            std::vector<T> sin; //!< Imaginary parts of the twiddles, indexed by (k - 1) * m + p
+            
+            std::vector<T> rootCos; //!< Real parts of the radix' roots of unity (generic butterflies only)
+            std::vector<T> rootSin; //!< Imaginary parts of the radix' roots of unity (generic butterflies only)
+        };
+        
+    private:
+        //! Deinterleave into a split work buffer, transform and interleave back
+        void transformInterleaved(const std::complex<T>* in, std::complex<T>* out, bool inverse) const
+        {
+            static thread_local std::vector<T> split;
+            if (split.size() < n * 2)
+                split.resize(n * 2);
+            
+            T* real = split.data();
+            T* imag = split.data() + n;
+            deinterleaveComplex(in, n, real, imag);
+            
+            if (inverse)
+                this->inverse(real, imag);
+            else
+                forward(real, imag);
+            
+            interleaveComplex(real, imag, n, out);
+        }
+        
+        //! Radix-2 butterflies
+        static void butterfly2(const Stage& stage, const T* xr, const T* xi, T* yr, T* yi)
+        {
+            const auto m = stage.m;
+            const auto s = stage.stride;
+            
+            for (std::size_t p = 0; p < m; ++p)
+            {
+                const auto wr = stage.cos[p];
+                const auto wi = stage.sin[p];
+                
+                for (std::size_t q = 0; q < s; ++q)
+                {
+                    const auto ar = xr[q + s * p];
+                    const auto ai = xi[q + s * p];
+                    const auto br = xr[q + s * (p + m)];
+                    const auto bi = xi[q + s * (p + m)];
+                    
+                    yr[q + s * (2 * p)] = ar + br;
+                    yi[q + s * (2 * p)] = ai + bi;
+                    
+                    const auto dr = ar - br;
+                    const auto di = ai - bi;
+                    yr[q + s * (2 * p + 1)] = dr * wr - di * wi;
+                    yi[q + s * (2 * p + 1)] = dr * wi + di * wr;
+                }
+            }
+        }
+        
+        //! Radix-4 butterflies
+        static void butterfly4(const Stage& stage, const T* xr, const T* xi, T* yr, T* yi)
+        {
+            const auto m = stage.m;
+            const auto s = stage.stride;
+            
+            for (std::size_t p = 0; p < m; ++p)
+            {
+                const auto w1r = stage.cos[p];
+                const auto w1i = stage.sin[p];
+                const auto w2r = stage.cos[m + p];
+                const auto w2i = stage.sin[m + p];
+                const auto w3r = stage.cos[2 * m + p];
+                const auto w3i = stage.sin[2 * m + p];
+                
+                for (std::size_t q = 0; q < s; ++q)
+                {
+                    const auto a0r = xr[q + s * p];
+                    const auto a0i = xi[q + s * p];
+                    const auto a1r = xr[q + s * (p + m)];
+                    const auto a1i = xi[q + s * (p + m)];
+                    const auto a2r = xr[q + s * (p + 2 * m)];
+                    const auto a2i = xi[q + s * (p + 2 * m)];
+                    const auto a3r = xr[q + s * (p + 3 * m)];
+                    const auto a3i = xi[q + s * (p + 3 * m)];
+                    
+                    const auto t0r = a0r + a2r;
+                    const auto t0i = a0i + a2i;
+                    const auto t1r = a0r - a2r;
+                    const auto t1i = a0i - a2i;
+                    const auto t2r = a1r + a3r;
+                    const auto t2i = a1i + a3i;
+                    
+                    // Multiply (a1 - a3) by -i
+                    const auto t3r = a1i - a3i;
+                    const auto t3i = a3r - a1r;
+                    
+                    const auto y1r = t1r + t3r;
+                    const auto y1i = t1i + t3i;
+                    const auto y2r = t0r - t2r;
+                    const auto y2i = t0i - t2i;
+                    const auto y3r = t1r - t3r;
+                    const auto y3i = t1i - t3i;
+                    
+                    yr[q + s * (4 * p)] = t0r + t2r;
+                    yi[q + s * (4 * p)] = t0i + t2i;
+                    yr[q + s * (4 * p + 1)] = y1r * w1r - y1i * w1i;
+                    yi[q + s * (4 * p + 1)] = y1r * w1i + y1i * w1r;
+                    yr[q + s * (4 * p + 2)] = y2r * w2r - y2i * w2i;
+                    yi[q + s * (4 * p + 2)] = y2r * w2i + y2i * w2r;
+                    yr[q + s * (4 * p + 3)] = y3r * w3r - y3i * w3i;
+                    yi[q + s * (4 * p + 3)] = y3r * w3i + y3i * w3r;
+                }
+            }
+        }
+        
+        //! Generic butterflies for odd radices, computed as a direct DFT of the radix' size
+        static void butterfly(const Stage& stage, const T* xr, const T* xi, T* yr, T* yi)
+        {
+            const auto r = stage.radix;
+            const auto m = stage.m;
+            const auto s = stage.stride;
+            
+            for (std::size_t p = 0; p < m; ++p)
+            {
+                for (std::size_t k = 0; k < r; ++k)
+                {
+                    const auto wr = k == 0 ? T{1} : stage.cos[(k - 1) * m + p];
+                    const auto wi = k == 0 ? T{0} : stage.sin[(k - 1) * m + p];
+                    
+                    for (std::size_t q = 0; q < s; ++q)
+                    {
+                        T sumr = 0;
+                        T sumi = 0;
+                        for (std::size_t j = 0; j < r; ++j)
+                        {
+                            const auto root = (j * k) % r;
+                            const auto ar = xr[q + s * (p + j * m)];
+                            const auto ai = xi[q + s * (p + j * m)];
+                            sumr += ar * stage.rootCos[root] - ai * stage.rootSin[root];
+                            sumi += ar * stage.rootSin[root] + ai * stage.rootCos[root];
+                        }
+                        
+                        yr[q + s * (r * p + k)] = sumr * wr - sumi * wi;
+                        yi[q + s * (r * p + k)] = sumr * wi + sumi * wr;
+                    }
+                }
+            }
+        }
+        
+    private:
+        //! The number of points in the transform
+        std::size_t n = 0;
+        
+        //! The Stockham passes, in order of execution
+        std::vector<Stage> stages;
+    };
+    
+    //! Fast Fourier transform of real signals
+    /*! Packs the even and odd samples into a complex transform of half the size, and untangles the
+        result into the size / 2 + 1 non-negative frequency bins. The negative frequencies are the
+        complex conjugates of those, and are not computed. */
+    template <class T>
+    class RealFft
+    {
+    public:
+        //! Construct the transform for a given size
+        /*! @throw std::invalid_argument if size is zero or odd */
+        RealFft(std::size_t size) :
+            fft(halve(size)),
+            cos(size / 2 + 1),
+            sin(size / 2 + 1)
+        {
+            for (std::size_t k = 0; k < cos.size(); ++k)
+            {
+                cos[k] = std::cos(-TWO_PI<double> * k / size);
+                sin[k] = std::sin(-TWO_PI<double> * k / size);
+            }
+        }
+        
+        //! Transform a real signal into split-complex bins
+        /*! Writes size / 2 + 1 bins to both real and imag */
+        void forward(const T* in, T* real, T* imag) const
+        {
+            const auto half = fft.size();
+            
+            // Treat even samples as real and odd samples as imaginary parts
+            static thread_local std::vector<T> work;
+            if (work.size() < half * 2)
+                work.resize(half * 2);
+            
+            T* zr = work.data();
+            T* zi = work.data() + half;
+            for (std::size_t i = 0; i < half; ++i)
+            {
+                zr[i] = in[2 * i];
+                zi[i] = in[2 * i + 1];
+            }
+            
+            fft.forward(zr, zi);
+            
+            for (std::size_t k = 0; k <= half; ++k)
+            {
+                // Z[k] and the conjugate of Z[half - k]
+                const auto ar = zr[k % half];
+                const auto ai = zi[k % half];
+                const auto br = zr[(half - k) % half];
+                const auto bi = -zi[(half - k) % half];
+                
+                // Even part (Z[k] + conj(Z[half - k])) / 2, odd part (Z[k] - conj(Z[half - k])) / 2i
+                const auto er = (ar + br) * T{0.5};
+                const auto ei = (ai + bi) * T{0.5};
+                const auto or_ = (ai - bi) * T{0.5};
+                const auto oi = (br - ar) * T{0.5};
+                
+                real[k] = er + or_ * cos[k] - oi * sin[k];
+                imag[k] = ei + or_ * sin[k] + oi * cos[k];
+            }
+        }
+        
+        //! Transform a real signal into interleaved complex bins
+        /*! Writes size / 2 + 1 bins to the output */
+        void forward(const T* in, std::complex<T>* out) const
+        {
+            static thread_local std::vector<T> split;
+            if (split.size() < (fft.size() + 1) * 2)
+                split.resize((fft.size() + 1) * 2);
+            
+            T* real = split.data();
+            T* imag = split.data() + fft.size() + 1;
+            forward(in, real, imag);
+            
+            interleaveComplex(real, imag, fft.size() + 1, out);
+        }
+        
+        //! Transform split-complex bins back into a real signal
+        /*! Reads size / 2 + 1 bins. The output is scaled by 1 / size, so that inverse(forward(x)) == x */
+        void inverse(const T* real, const T* imag, T* out) const
+        {
+            const auto half = fft.size();
+            
+            static thread_local std::vector<T> work;
+            if (work.size() < half * 2)
+                work.resize(half * 2);
+            
+            T* zr = work.data();
+            T* zi = work.data() + half;
+            for (std::size_t k = 0; k < half; ++k)
+            {
+                // X[k] and the conjugate of X[half - k]
+                const auto ar = real[k];
+                const auto ai = imag[k];
+                const auto br = real[half - k];
+                const auto bi = -imag[half - k];
+                
+                // Even part (X[k] + conj(X[half - k])), odd part (X[k] - conj(X[half - k])) * w^-k
+                const auto er = ar + br;
+                const auto ei = ai + bi;
+                const auto dr = ar - br;
+                const auto di = ai - bi;
+                const auto or_ = dr * cos[k] + di * sin[k];
+                const auto oi = di * cos[k] - dr * sin[k];
+                
+                // Z[k] = even + i * odd
+                zr[k] = er - oi;
+                zi[k] = ei + or_;
+            }
+            
+            fft.inverse(zr, zi);
+            
+            // The inverse of the half-size transform already scales by 2 / size, account for the doubled parts above
+            for (std::size_t i = 0; i < half; ++i)
+            {
+                out[2 * i] = zr[i] * T{0.5};
+                out[2 * i + 1] = zi[i] * T{0.5};
+            }
+        }
+        
+        //! Transform interleaved complex bins back into a real signal
+        /*! Reads size / 2 + 1 bins. The output is scaled by 1 / size, so that inverse(forward(x)) == x */
+        void inverse(const std::complex<T>* in, T* out) const
+        {
+            static thread_local std::vector<T> split;
+            if (split.size() < (fft.size() + 1) * 2)
+                split.resize((fft.size() + 1) * 2);
+            
+            T* real = split.data();
+            T* imag = split.data() + fft.size() + 1;
+            deinterleaveComplex(in, fft.size() + 1, real, imag);
+            
+            inverse(real, imag, out);
+        }
+        
+        //! The number of real samples in the transform
+        std::size_t size() const { return fft.size() * 2; }
+        
+        //! The number of complex bins produced by the transform
+        std::size_t binCount() const { return fft.size() + 1; }
+        
+    private:
+        //! Validate the size and compute the size of the complex transform
+        static std::size_t halve(std::size_t size)
+        {
+            if (size == 0 || size % 2 != 0)
+                throw std::invalid_argument("size is zero or odd");
+            
+            return size / 2;
+        }
+        
+    private:
+        //! The complex transform of half the size
+        Fft<T> fft;
+        
+        //! The twiddles e^(-2πik / size) used to untangle the half-size transform
+        std::vector<T> cos;
+        std::vector<T> sin;
+    };
+    
+    //! Retrieve a cached complex transform of a given size
+    /*! The transform is constructed on first use and shared from then on. Retrieval is thread-safe,
+        and so is using the returned transform from multiple threads.
+        @throw std::invalid_argument if size == 0 */
+    template <class T>
+    const Fft<T>& getFft(std::size_t size)
+    {
+        static std::mutex mutex;
+        static std::map<std::size_t, std::unique_ptr<const Fft<T>>> plans;
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& plan = plans[size];
+        if (!plan)
+            plan = std::make_unique<const Fft<T>>(size);
+        
+        return *plan;
+    }
+    
+    //! Retrieve a cached real transform of a given size
+    /*! The transform is constructed on first use and shared from then on. Retrieval is thread-safe,
+        and so is using the returned transform from multiple threads.
+        @throw std::invalid_argument if size is zero or odd */
+    template <class T>
+    const RealFft<T>& getRealFft(std::size_t size)
+    {
+        static std::mutex mutex;
+        static std::map<std::size_t, std::unique_ptr<const RealFft<T>>> plans;
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& plan = plans[size];
+        if (!plan)
+            plan = std::make_unique<const RealFft<T>>(size);
+        
+        return *plan;
+    }
+}
+
+#endif
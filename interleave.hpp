@@ -9,12 +9,18 @@
 #ifndef DSPERADOS_MATH_INTERLEAVE_HPP
 #define DSPERADOS_MATH_INTERLEAVE_HPP
 
+#include <algorithm>
 #include <cmath>
 #include <complex>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
+#include "utility.hpp"
+
 namespace math
 {
     //! Interleave two ranges
@@ -38,6 +44,387 @@ namespace math
             *outBegin2++ = *it;
         }
     }
+    
+    //! Interleave a fixed number of channels
+    /*! Transposes tiles of four frames at a time through a local block, which lets the compiler turn
+        the loads into vector loads and the transpose into unpack/shuffle instructions */
+    template <std::size_t ChannelCount, class T>
+    void interleave(const T* const* channels, std::size_t frames, T* out)
+    {
+        const T* in[ChannelCount];
+        std::copy(channels, channels + ChannelCount, in);
+        
+        std::size_t frame = 0;
+        for (; frame + 4 <= frames; frame += 4)
+        {
+            T tile[ChannelCount][4];
+            for (std::size_t channel = 0; channel < ChannelCount; ++channel)
+                for (std::size_t i = 0; i < 4; ++i)
+                    tile[channel][i] = in[channel][frame + i];
+            
+            auto o = out + frame * ChannelCount;
+            for (std::size_t i = 0; i < 4; ++i)
+                for (std::size_t channel = 0; channel < ChannelCount; ++channel)
+                    o[i * ChannelCount + channel] = tile[channel][i];
+        }
+        
+        for (; frame < frames; ++frame)
+            for (std::size_t channel = 0; channel < ChannelCount; ++channel)
+                out[frame * ChannelCount + channel] = in[channel][frame];
+    }
+    
+    //! Deinterleave into a fixed number of channels
+    /*! Transposes tiles of four frames at a time through a local block, which lets the compiler turn
+        the stores into vector stores and the transpose into unpack/shuffle instructions */
+    template <std::size_t ChannelCount, class T>
+    void deinterleave(const T* in, std::size_t frames, T* const* channels)
+    {
+        T* out[ChannelCount];
+        std::copy(channels, channels + ChannelCount, out);
+        
+        std::size_t frame = 0;
+        for (; frame + 4 <= frames; frame += 4)
+        {
+            T tile[ChannelCount][4];
+            auto frameIn = in + frame * ChannelCount;
+            for (std::size_t i = 0; i < 4; ++i)
+                for (std::size_t channel = 0; channel < ChannelCount; ++channel)
+                    tile[channel][i] = frameIn[i * ChannelCount + channel];
+            
+            for (std::size_t channel = 0; channel < ChannelCount; ++channel)
+                for (std::size_t i = 0; i < 4; ++i)
+                    out[channel][frame + i] = tile[channel][i];
+        }
+        
+        for (; frame < frames; ++frame)
+            for (std::size_t channel = 0; channel < ChannelCount; ++channel)
+                out[channel][frame] = in[frame * ChannelCount + channel];
+    }
+    
+    //! The number of frames per block in the generic interleaving loops
+    /*! Keeps the strided side of the transpose inside the L1 cache for up to 32 channels */
+    constexpr std::size_t INTERLEAVE_BLOCK_SIZE = 64;
+    
+    //! Interleave an arbitrary number of channels
+    /*! Uses the tiled kernels for 1, 2, 4 and 8 channels, and a cache-blocked loop for all others
+        @param channels Pointers to the first sample of each channel
+        @param out Receives frames * channelCount samples */
+    template <class T>
+    void interleave(const T* const* channels, std::size_t channelCount, std::size_t frames, T* out)
+    {
+        switch (channelCount)
+        {
+            case 0: return;
+            case 1: std::copy(channels[0], channels[0] + frames, out); return;
+            case 2: interleave<2>(channels, frames, out); return;
+            case 4: interleave<4>(channels, frames, out); return;
+            case 8: interleave<8>(channels, frames, out); return;
+        }
+        
+        for (std::size_t block = 0; block < frames; block += INTERLEAVE_BLOCK_SIZE)
+        {
+            const auto end = std::min(block + INTERLEAVE_BLOCK_SIZE, frames);
+            for (std::size_t channel = 0; channel < channelCount; ++channel)
+            {
+                const auto in = channels[channel];
+                for (std::size_t frame = block; frame < end; ++frame)
+                    out[frame * channelCount + channel] = in[frame];
+            }
+        }
+    }
+    
+    //! Deinterleave into an arbitrary number of channels
+    /*! Uses the tiled kernels for 1, 2, 4 and 8 channels, and a cache-blocked loop for all others
+        @param in Contains frames * channelCount samples
+        @param channels Pointers to the first sample of each channel */
+    template <class T>
+    void deinterleave(const T* in, std::size_t channelCount, std::size_t frames, T* const* channels)
+    {
+        switch (channelCount)
+        {
+            case 0: return;
+            case 1: std::copy(in, in + frames, channels[0]); return;
+            case 2: deinterleave<2>(in, frames, channels); return;
+            case 4: deinterleave<4>(in, frames, channels); return;
+            case 8: deinterleave<8>(in, frames, channels); return;
+        }
+        
+        for (std::size_t block = 0; block < frames; block += INTERLEAVE_BLOCK_SIZE)
+        {
+            const auto end = std::min(block + INTERLEAVE_BLOCK_SIZE, frames);
+            for (std::size_t channel = 0; channel < channelCount; ++channel)
+            {
+                const auto out = channels[channel];
+                for (std::size_t frame = block; frame < end; ++frame)
+                    out[frame] = in[frame * channelCount + channel];
+            }
+        }
+    }
+    
+    //! Signed 16-bit integer samples
+    struct Int16Format
+    {
+        using Storage = std::int16_t; //!< The type pointed to by interleaved buffers
+        static constexpr std::size_t bits = 16; //!< The number of significant bits
+        static constexpr std::size_t storagePerSample = 1; //!< The number of Storage elements per sample
+        
+        //! Read the sample at a given sample index
+        static std::int32_t read(const Storage* data, std::size_t index) { return data[index]; }
+        
+        //! Write the sample at a given sample index
+        static void write(Storage* data, std::size_t index, std::int32_t value) { data[index] = static_cast<Storage>(value); }
+    };
+    
+    //! Signed 24-bit integer samples, packed in three little-endian bytes
+    struct Int24Format
+    {
+        using Storage = std::uint8_t; //!< The type pointed to by interleaved buffers
+        static constexpr std::size_t bits = 24; //!< The number of significant bits
+        static constexpr std::size_t storagePerSample = 3; //!< The number of Storage elements per sample
+        
+        //! Read the sample at a given sample index
+        static std::int32_t read(const Storage* data, std::size_t index)
+        {
+            const auto bytes = data + index * 3;
+            const std::uint32_t value = bytes[0] | (bytes[1] << 8) | (static_cast<std::uint32_t>(bytes[2]) << 16);
+            
+            // Shift the sign bit into place and back to sign-extend
+            return static_cast<std::int32_t>(value << 8) >> 8;
+        }
+        
+        //! Write the sample at a given sample index
+        static void write(Storage* data, std::size_t index, std::int32_t value)
+        {
+            const auto bytes = data + index * 3;
+            bytes[0] = static_cast<Storage>(value);
+            bytes[1] = static_cast<Storage>(value >> 8);
+            bytes[2] = static_cast<Storage>(value >> 16);
+        }
+    };
+    
+    //! Signed 32-bit integer samples
+    struct Int32Format
+    {
+        using Storage = std::int32_t; //!< The type pointed to by interleaved buffers
+        static constexpr std::size_t bits = 32; //!< The number of significant bits
+        static constexpr std::size_t storagePerSample = 1; //!< The number of Storage elements per sample
+        
+        //! Read the sample at a given sample index
+        static std::int32_t read(const Storage* data, std::size_t index) { return data[index]; }
+        
+        //! Write the sample at a given sample index
+        static void write(Storage* data, std::size_t index, std::int32_t value) { data[index] = value; }
+    };
+    
+    //! Function object for quantization without dither
+    struct NoDither
+    {
+        //! The offset in least significant bits, which is always zero
+        constexpr double operator()() const { return 0; }
+    };
+    
+    //! Function object generating triangular (TPDF) dither
+    /*! Generates noise in the range [-1, 1) least significant bits, as the sum of two uniform values
+        taken from the upper 16 bits of two successive linear congruential steps (the lower bits have
+        a short period). The state is kept in the object, so dither stays uncorrelated across
+        successive blocks. */
+    struct TpdfDither
+    {
+        TpdfDither(std::uint32_t seed = 1) : state(seed) { }
+        
+        //! The next dither offset in least significant bits
+        double operator()()
+        {
+            state = state * 1664525u + 1013904223u;
+            const auto a = state >> 16;
+            state = state * 1664525u + 1013904223u;
+            const auto b = state >> 16;
+            return (a + b) / 65536.0 - 1.0;
+        }
+        
+        std::uint32_t state = 1;
+    };
+    
+    //! Convert interleaved integer samples and deinterleave them into floating-point channels
+    /*! Conversion and deinterleaving happen in a single cache-blocked pass, so the integer data is read
+        exactly once. Samples are scaled to [-1, 1).
+        @param in Contains frames * channelCount samples in the given Format
+        @param channels Pointers to the first sample of each channel
+        
+        @code{cpp}
+        deinterleaveConvert<Int24Format>(bytes, 8, frames, channels);
+        @endcode */
+    template <class Format, class T>
+    void deinterleaveConvert(const typename Format::Storage* in, std::size_t channelCount, std::size_t frames, T* const* channels)
+    {
+        static_assert(std::is_floating_point<T>::value, "channels need to be floating-point");
+        
+        const T factor = T{1} / (std::uint64_t{1} << (Format::bits - 1));
+        
+        for (std::size_t block = 0; block < frames; block += INTERLEAVE_BLOCK_SIZE)
+        {
+            const auto end = std::min(block + INTERLEAVE_BLOCK_SIZE, frames);
+            for (std::size_t channel = 0; channel < channelCount; ++channel)
+            {
+                const auto out = channels[channel];
+                for (std::size_t frame = block; frame < end; ++frame)
+                    out[frame] = static_cast<T>(Format::read(in, frame * channelCount + channel)) * factor;
+            }
+        }
+    }
+    
+    //! Interleave floating-point channels and convert them to integer samples
+    /*! Scaling, dithering, rounding, saturation and interleaving happen in a single cache-blocked pass,
+        so the integer data is written exactly once. Samples outside [-1, 1) are clipped.
+        @param channels Pointers to the first sample of each channel
+        @param out Receives frames * channelCount samples in the given Format
+        @param dither Function object returning the dither offset in least significant bits
+        
+        @code{cpp}
+        TpdfDither dither;
+        interleaveConvert<Int16Format>(channels, 2, frames, out, dither);
+        @endcode */
+    template <class Format, class T, class Dither = NoDither>
+    void interleaveConvert(const T* const* channels, std::size_t channelCount, std::size_t frames, typename Format::Storage* out, Dither&& dither = Dither())
+    {
+        static_assert(std::is_floating_point<T>::value, "channels need to be floating-point");
+        
+        // 32-bit samples don't fit in the mantissa of a float, so compute those in double precision
+        using Compute = std::conditional_t<(Format::bits > 24), double, T>;
+        
+        const Compute scale = std::uint64_t{1} << (Format::bits - 1);
+        const Compute min = -scale;
+        const Compute max = scale - 1;
+        
+        for (std::size_t block = 0; block < frames; block += INTERLEAVE_BLOCK_SIZE)
+        {
+            const auto end = std::min(block + INTERLEAVE_BLOCK_SIZE, frames);
+            for (std::size_t channel = 0; channel < channelCount; ++channel)
+            {
+                const auto in = channels[channel];
+                for (std::size_t frame = block; frame < end; ++frame)
+                {
+                    auto value = static_cast<Compute>(in[frame]) * scale + static_cast<Compute>(dither());
+                    value = value < min ? min : max < value ? max : value;
+                    
+                    // Round half away from zero, the truncating conversion keeps this branch-free
+                    const auto rounded = static_cast<std::int32_t>(value + (value < 0 ? Compute{-0.5} : Compute{0.5}));
+                    Format::write(out, frame * channelCount + channel, rounded);
+                }
+            }
+        }
+    }
+    
+    //! Non-owning view of a split-complex buffer
+    /*! Pairs a real and an imaginary array of equal size, so that split-complex data can be passed
+        around as one object and accessed as std::complex values */
+    template <class T>
+    class SplitComplexView
+    {
+    public:
+        SplitComplexView(T* real, T* imag, std::size_t size) : realData(real), imagData(imag), count(size) { }
+        
+        //! Read an element as a complex number
+        std::complex<std::remove_const_t<T>> operator[](std::size_t index) const { return {realData[index], imagData[index]}; }
+        
+        //! Write an element
+        void set(std::size_t index, const std::complex<std::remove_const_t<T>>& value)
+        {
+            realData[index] = value.real();
+            imagData[index] = value.imag();
+        }
+        
+        //! The real parts
+        T* real() const { return realData; }
+        
+        //! The imaginary parts
+        T* imag() const { return imagData; }
+        
+        //! The number of complex elements
+        std::size_t size() const { return count; }
+        
+    private:
+        T* realData = nullptr;
+        T* imagData = nullptr;
+        std::size_t count = 0;
+    };
+    
+    //! Split an array of complex numbers into a real and imaginary array
+    /*! std::complex is guaranteed to be laid out as two consecutive values, so this is a two channel
+        deinterleave and uses the same tiled kernel */
+    template <class T>
+    void deinterleaveComplex(const std::complex<T>* in, std::size_t size, T* real, T* imag)
+    {
+        T* const channels[] = {real, imag};
+        deinterleave<2>(reinterpret_cast<const T*>(in), size, channels);
+    }
+    
+    //! Join a real and imaginary array into an array of complex numbers
+    /*! std::complex is guaranteed to be laid out as two consecutive values, so this is a two channel
+        interleave and uses the same tiled kernel */
+    template <class T>
+    void interleaveComplex(const T* real, const T* imag, std::size_t size, std::complex<T>* out)
+    {
+        const T* const channels[] = {real, imag};
+        interleave<2>(channels, size, reinterpret_cast<T*>(out));
+    }
+    
+    //! Turn a0 b0 a1 b1 ... into a0 a1 ... b0 b1 ..., for a power-of-two number of pairs
+    template <class T>
+    void deinterleavePairs(T* data, std::size_t pairs)
+    {
+        if (pairs < 2)
+            return;
+        
+        // Split both halves into [A1 B1] [A2 B2], then swap B1 and A2
+        const auto half = pairs / 2;
+        deinterleavePairs(data, half);
+        deinterleavePairs(data + pairs, half);
+        std::swap_ranges(data + half, data + pairs, data + pairs);
+    }
+    
+    //! Turn a0 a1 ... b0 b1 ... into a0 b0 a1 b1 ..., for a power-of-two number of pairs
+    template <class T>
+    void interleavePairs(T* data, std::size_t pairs)
+    {
+        if (pairs < 2)
+            return;
+        
+        // Swap the middle quarters of [A1 A2 B1 B2], then join both halves [A1 B1] [A2 B2]
+        const auto half = pairs / 2;
+        std::swap_ranges(data + half, data + pairs, data + pairs);
+        interleavePairs(data, half);
+        interleavePairs(data + pairs, half);
+    }
+    
+    //! Split an array of complex numbers into real and imaginary halves in-place
+    /*! Afterwards the buffer holds all real parts, followed by all imaginary parts. Works by recursively
+        splitting both halves and swapping the middle quarters, which takes O(n log n) swaps and no memory.
+        @throw std::invalid_argument if size is not a power of two
+        @return A view of the split halves */
+    template <class T>
+    SplitComplexView<T> deinterleaveComplexInPlace(std::complex<T>* data, std::size_t size)
+    {
+        if (!isPowerOf2(size))
+            throw std::invalid_argument("size is not a power of two");
+        
+        auto values = reinterpret_cast<T*>(data);
+        deinterleavePairs(values, size);
+        
+        return {values, values + size, size};
+    }
+    
+    //! Join real and imaginary halves into an array of complex numbers in-place
+    /*! The inverse of deinterleaveComplexInPlace(), expects all real parts followed by all imaginary parts.
+        @throw std::invalid_argument if size is not a power of two */
+    template <class T>
+    void interleaveComplexInPlace(std::complex<T>* data, std::size_t size)
+    {
+        if (!isPowerOf2(size))
+            throw std::invalid_argument("size is not a power of two");
+        
+        interleavePairs(reinterpret_cast<T*>(data), size);
+    }
 }
 
 #endif
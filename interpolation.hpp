@@ -14,6 +14,7 @@
 #include <utility>
 
 #include "access.hpp"
+#include "approximation.hpp"
 #include "constants.hpp"
 
 namespace math
@@ -33,10 +34,11 @@ namespace math
     }
 
     //! Interpolate between two numbers using cosine interpolation
-    template <class T, class Index>
+    /*! @tparam Math The math policy, use FastMath to opt into the fast approximations */
+    template <class T, class Index, class Math = StandardMath>
     constexpr auto interpolateCosine(Index index, const T& x1, const T& x2)
     {
-        auto t = (1 - cos(index * PI<double>)) / 2.0;
+        auto t = (1 - Math::cos(index * PI<double>)) / 2.0;
         return x1 + t * (x2 - x1);
     }
 
@@ -236,9 +238,10 @@ namespace math
     }
 
     //! Scale a number from one range to another with a skew factor computed from a middle value
-    /*! @throw std::invalid_argument if max1 <= min1 and if middle2 <= min2 or middle2 >= max2 */
-    template <class T1, class T2, class T3, class T4, class T5, class T6>
-    auto skew(const T1& value, const T2& min1, const T3& max1, const T4& min2, const T5& middle2, const T6& max2)
+    /*! @throw std::invalid_argument if max1 <= min1 and if middle2 <= min2 or middle2 >= max2
+        @tparam Math The math policy, pass FastMath<>() as last argument to opt into the fast approximations */
+    template <class T1, class T2, class T3, class T4, class T5, class T6, class Math = StandardMath>
+    auto skew(const T1& value, const T2& min1, const T3& max1, const T4& min2, const T5& middle2, const T6& max2, Math = Math{})
     {
         if (max1 <= min1)
             throw std::invalid_argument("max1 <= min1");
@@ -249,17 +252,18 @@ namespace math
 
         // Solve exponent for 0.5^exponent * (max2 - min2) = middle2
         auto temp = (middle2 - min2) / static_cast<long double>(max2 - min2);
-        auto exponent = log10l(temp) / log10l(0.5l);
+        auto exponent = Math::log(temp) / Math::log(0.5l);
 
         auto normalisedValue = scale(value, min1, max1, 0.0l, 1.0l);
 
-        return powl(normalisedValue, exponent) * (max2 - min2) + min2;
+        return Math::pow(normalisedValue, exponent) * (max2 - min2) + min2;
     }
 
     //! Convert from a linear to a logarithmic scale
-    /*! @throw std::invalid_argument if min2 or max2 <= 0 */
-    template <class T1, class T2, class T3, class T4, class T5>
-    auto lin2log(const T1& value, const T2& min1, const T3& max1, const T4& min2, const T5& max2)
+    /*! @throw std::invalid_argument if min2 or max2 <= 0
+        @tparam Math The math policy, pass FastMath<>() as last argument to opt into the fast approximations */
+    template <class T1, class T2, class T3, class T4, class T5, class Math = StandardMath>
+    auto lin2log(const T1& value, const T2& min1, const T3& max1, const T4& min2, const T5& max2, Math = Math{})
     {
         if (min2 <= 0)
             throw std::invalid_argument("min2 <= 0");
@@ -267,14 +271,15 @@ namespace math
         if (max2 <= 0)
             throw std::invalid_argument("max2 <= 0");
 
-        const auto exponent = scale(value, min1, max1, log(min2), log(max2));
-        return exp(exponent);
+        const auto exponent = scale(value, min1, max1, Math::log(min2), Math::log(max2));
+        return Math::exp(static_cast<double>(exponent));
     }
 
     //! Convert from a logarithmic to a linear scale
-    /*! @throw std::invalid_argument if value, min1 or max1 <= 0 */
-    template <class T1, class T2, class T3, class T4, class T5>
-    auto log2lin(const T1& value, const T2& min1, const T3& max1, const T4& min2, const T5& max2)
+    /*! @throw std::invalid_argument if value, min1 or max1 <= 0
+        @tparam Math The math policy, pass FastMath<>() as last argument to opt into the fast approximations */
+    template <class T1, class T2, class T3, class T4, class T5, class Math = StandardMath>
+    auto log2lin(const T1& value, const T2& min1, const T3& max1, const T4& min2, const T5& max2, Math = Math{})
     {
         if (value <= 0)
             throw std::invalid_argument("value <= 0");
@@ -285,7 +290,7 @@ namespace math
         if (max1 <= 0)
             throw std::invalid_argument("max1 <= 0");
 
-        return scale<double>(log(value), log(min1), log(max1), min2, max2);
+        return scale<double>(Math::log(value), Math::log(min1), Math::log(max1), min2, max2);
     }
 }
 
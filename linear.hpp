@@ -11,8 +11,10 @@
 
 #include <cmath>
 #include <cstddef>
+#include <type_traits>
 #include <vector>
 
+#include "stride.hpp"
 
 namespace math
 {
@@ -22,7 +24,7 @@ namespace math
     {
         std::common_type_t<decltype(*begin1), decltype(*begin2)> out = {0};
         
-        for (auto i = 0; i < size; ++i)
+        for (std::size_t i = 0; i < size; ++i)
         {
             out += *begin1 * *begin2;
             begin1 += stride1;
@@ -33,10 +35,40 @@ namespace math
     }
     
     //! Take the dot product of two containers
+    /*! Accumulates into four independent partial sums, so that contiguous ranges can be vectorized */
     template <class InputIterator1, class InputIterator2>
     auto dot(InputIterator1 begin1, InputIterator2 begin2, std::size_t size)
     {
-        return dot(begin1, 1, begin2, 1, size);
+        using T = std::common_type_t<decltype(*begin1), decltype(*begin2)>;
+        T sum0 = {0};
+        T sum1 = {0};
+        T sum2 = {0};
+        T sum3 = {0};
+        
+        std::size_t i = 0;
+        for (; i + 4 <= size; i += 4)
+        {
+            sum0 += begin1[i] * begin2[i];
+            sum1 += begin1[i + 1] * begin2[i + 1];
+            sum2 += begin1[i + 2] * begin2[i + 2];
+            sum3 += begin1[i + 3] * begin2[i + 3];
+        }
+        
+        for (; i < size; ++i)
+            sum0 += begin1[i] * begin2[i];
+        
+        return (sum0 + sum1) + (sum2 + sum3);
+    }
+    
+    //! Take the dot product of two strided ranges
+    /*! Recognizes the strides, and runs directly on the underlying iterators */
+    template <class Iterator1, class Iterator2>
+    auto dot(StridedIterator<Iterator1> begin1, StridedIterator<Iterator2> begin2, std::size_t size)
+    {
+        if (size == 0)
+            return std::common_type_t<decltype(*begin1), decltype(*begin2)>{0};
+        
+        return dot(begin1.base(), begin1.stride(), begin2.base(), begin2.stride(), size);
     }
 }
 
@@ -0,0 +1,152 @@
+//
+//  noise.hpp
+//  Math
+//
+//  Copyright © 2015-2016 Dsperados (info@dsperados.com). All rights reserved.
+//  Licensed under the BSD 3-clause license.
+//
+
+#ifndef DSPERADOS_MATH_NOISE_HPP
+#define DSPERADOS_MATH_NOISE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+
+#include "random.hpp"
+
+namespace math
+{
+    //! Pink noise generator using the Voss-McCartney algorithm
+    /*! Sums a white noise sample with ROWS random rows, where row i is renewed every 2^(i+1) samples.
+        Only a single row changes per sample, so the sum is updated incrementally. The rows are carried
+        between calls, so consecutive blocks form one continuous signal. Output lies within [-1, 1).
+        
+        @code{cpp}
+        PinkNoise<float> pink;
+        std::mt19937 engine(42);
+        
+        pink.generate(buffer.begin(), buffer.end(), engine);
+        @endcode */
+    template <typename T>
+    class PinkNoise
+    {
+    public:
+        //! The number of rows, which sets the lowest octave with a 1/f slope
+        static constexpr std::size_t ROWS = 16;
+        
+    public:
+        //! Fill a range with pink noise
+        template <typename ForwardIterator, typename Engine>
+        void generate(ForwardIterator begin, ForwardIterator end, Engine& engine)
+        {
+            static constexpr T scale = T{1} / (ROWS + 1);
+            T white[RANDOM_BLOCK_SIZE];
+            T renewal[RANDOM_BLOCK_SIZE];
+            
+            for (auto remaining = static_cast<std::size_t>(std::distance(begin, end)); remaining > 0;)
+            {
+                const auto count = std::min(remaining, RANDOM_BLOCK_SIZE);
+                remaining -= count;
+                
+                generateUniformRandom(white, white + count, -1, 1, engine);
+                generateUniformRandom(renewal, renewal + count, -1, 1, engine);
+                
+                for (std::size_t i = 0; i < count; ++i, ++begin)
+                {
+                    // The row to renew is the number of trailing zeros of the counter
+                    counter = (counter + 1) & ((1u << ROWS) - 1);
+                    if (counter != 0)
+                    {
+                        std::size_t row = 0;
+                        for (auto c = counter; (c & 1) == 0; c >>= 1)
+                            ++row;
+                        
+                        sum += renewal[i] - rows[row];
+                        rows[row] = renewal[i];
+                    }
+                    
+                    *begin = (sum + white[i]) * scale;
+                }
+            }
+        }
+        
+        //! Clear the rows
+        void reset()
+        {
+            rows.fill(0);
+            sum = 0;
+            counter = 0;
+        }
+        
+    private:
+        //! The current value of each row
+        std::array<T, ROWS> rows = {};
+        
+        //! The sum of all rows
+        T sum = 0;
+        
+        //! The sample counter, which decides the row to renew
+        std::uint32_t counter = 0;
+    };
+    
+    //! Brown (red) noise generator
+    /*! Integrates Gaussian white noise through a leaky integrator, to keep the output from drifting.
+        The input is scaled so the output has unit variance. The integrator state is carried between
+        calls, so consecutive blocks form one continuous signal. */
+    template <typename T>
+    class BrownNoise
+    {
+    public:
+        //! Construct the generator
+        /*! @param leak The integrator coefficient, closer to 1 gives a steeper slope down to lower frequencies
+            @throw std::invalid_argument if leak is not within [0, 1) */
+        BrownNoise(T leak = 0.999) :
+            leak(leak),
+            gain(std::sqrt(1 - leak * leak))
+        {
+            if (leak < 0 || leak >= 1)
+                throw std::invalid_argument("leak not within [0, 1)");
+        }
+        
+        //! Fill a range with brown noise
+        /*! @warning The engine needs to satisfy producesFullWords() */
+        template <typename ForwardIterator, typename Engine>
+        void generate(ForwardIterator begin, ForwardIterator end, Engine& engine)
+        {
+            T white[RANDOM_BLOCK_SIZE];
+            
+            for (auto remaining = static_cast<std::size_t>(std::distance(begin, end)); remaining > 0;)
+            {
+                const auto count = std::min(remaining, RANDOM_BLOCK_SIZE);
+                remaining -= count;
+                
+                generateGaussianRandom(white, white + count, 0, gain, engine);
+                for (std::size_t i = 0; i < count; ++i, ++begin)
+                    *begin = state = leak * state + white[i];
+            }
+        }
+        
+        //! Clear the integrator
+        void reset()
+        {
+            state = 0;
+        }
+        
+    private:
+        //! The integrator coefficient
+        T leak = 0;
+        
+        //! The white noise gain that normalizes the output variance
+        T gain = 0;
+        
+        //! The integrator state
+        T state = 0;
+    };
+}
+
+#endif
@@ -11,8 +11,14 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <exception>
+#include <iterator>
 #include <numeric>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #include "analysis.hpp"
 
@@ -22,7 +28,7 @@ namespace math
     template <typename InputIterator, typename OutputIterator>
     void normalizeArea(InputIterator inBegin, InputIterator inEnd, OutputIterator outBegin)
     {
-        auto integral = std::accumulate(inBegin, inEnd, typename InputIterator::value_type{0});
+        auto integral = std::accumulate(inBegin, inEnd, typename std::iterator_traits<InputIterator>::value_type{0});
         
         if (!integral)
             throw std::runtime_error("area equals zero");
@@ -31,13 +37,502 @@ namespace math
     }
     
     //! Normalize a range
+    /*! Pointers and vector iterators find their peak with the vectorized findPeak(), after which the
+        scaling, in the value type of floating-point ranges, vectorizes as well
+        @throw std::runtime_error if the peak equals zero or is not a number */
     template <typename InputIterator, typename OutputIterator>
     void normalize(InputIterator inBegin, InputIterator inEnd, OutputIterator outBegin)
     {
+        if (inBegin == inEnd)
+            return;
+        
         const auto absoluteExtrema = std::abs(*findExtrema(inBegin, inEnd));
-        const auto factor = 1.0 / absoluteExtrema;
+        if (absoluteExtrema != absoluteExtrema)
+            throw std::runtime_error("peak is not a number");
+        
+        if (!absoluteExtrema)
+            throw std::runtime_error("peak equals zero");
+        
+        // Scale floating-point ranges in their own type, integers are scaled in double
+        using Value = typename std::iterator_traits<InputIterator>::value_type;
+        const auto factor = static_cast<std::conditional_t<std::is_floating_point<Value>::value, Value, double>>(1.0 / absoluteExtrema);
         std::transform(inBegin, inEnd, outBegin, [&](const auto& x){ return x * factor; });
     }
+    
+    //! The quantity a normalizer brings to a fixed value
+    enum class NormalizationMode
+    {
+        PEAK, //!< Scale the largest absolute value to one
+        AREA, //!< Scale the sum to one
+        RMS, //!< Scale the root mean square to one
+        Z_SCORE, //!< Offset the mean to zero, and scale the standard deviation to one
+        MIN_MAX, //!< Map the minimum to zero and the maximum to one
+        L2 //!< Scale the Euclidean norm to one
+    };
+    
+    //! Scale and offset a signal, as base + (x - offset) * factor, input and output may be the same
+    template <typename T>
+    void rescale(const T* in, T* out, std::size_t size, const T& offset, const T& factor, const T& base = 0)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+            out[i] = base + (in[i] - offset) * factor;
+    }
+    
+    //! Normalizer for signals too large to keep in memory, in two passes over chunks of the signal
+    /*! The first pass only gathers the statistics the mode needs, chunk by chunk, after which the
+        second pass scales, and for z-score and min-max offsets, the chunks. The chunks can be read from
+        a file or memory-mapped, and be of any size. Every statistic is reduced in columns, so the first
+        pass vectorizes as well as the second.
+        
+        @code{cpp}
+        StreamingNormalizer<float> normalizer;
+        while (auto size = file.read(chunk.data(), chunk.size()))
+            normalizer.analyze(chunk.data(), size);
+        
+        file.rewind();
+        while (auto size = file.read(chunk.data(), chunk.size()))
+            normalizer.process(chunk.data(), chunk.data(), size);
+        @endcode */
+    template <typename T>
+    class StreamingNormalizer
+    {
+    public:
+        //! Construct the normalizer
+        StreamingNormalizer(NormalizationMode mode = NormalizationMode::PEAK) :
+            mode(mode)
+        {
+            
+        }
+        
+        //! First pass, gather the statistics of the next chunk of the signal
+        void analyze(const T* data, std::size_t size)
+        {
+            if (size == 0)
+                return;
+            
+            switch (mode)
+            {
+                case NormalizationMode::PEAK:
+                {
+                    const auto magnitude = std::abs(static_cast<double>(findPeak(data, size).value));
+                    peak = magnitude != magnitude ? magnitude : std::max(peak, magnitude);
+                    break;
+                }
+                case NormalizationMode::AREA:
+                {
+                    T sums[REDUCTION_LANES] = {};
+                    reduceColumns(data, size, [&](std::size_t k, const T& x){ sums[k] += x; });
+                    area += std::accumulate(sums, sums + REDUCTION_LANES, 0.0);
+                    break;
+                }
+                case NormalizationMode::RMS:
+                case NormalizationMode::L2:
+                {
+                    T squares[REDUCTION_LANES] = {};
+                    reduceColumns(data, size, [&](std::size_t k, const T& x){ squares[k] += x * x; });
+                    sumOfSquares += std::accumulate(squares, squares + REDUCTION_LANES, 0.0);
+                    break;
+                }
+                case NormalizationMode::Z_SCORE:
+                {
+                    // Sum the deviations from the very first sample, which keeps the variance from cancelling out
+                    if (count == 0)
+                        shift = data[0];
+                    
+                    const auto origin = static_cast<T>(shift);
+                    T deviations[REDUCTION_LANES] = {};
+                    T squares[REDUCTION_LANES] = {};
+                    reduceColumns(data, size, [&](std::size_t k, const T& x)
+                    {
+                        const T deviation = x - origin;
+                        deviations[k] += deviation;
+                        squares[k] += deviation * deviation;
+                    });
+                    
+                    shiftedSum += std::accumulate(deviations, deviations + REDUCTION_LANES, 0.0);
+                    shiftedSumOfSquares += std::accumulate(squares, squares + REDUCTION_LANES, 0.0);
+                    break;
+                }
+                case NormalizationMode::MIN_MAX:
+                {
+                    T minima[REDUCTION_LANES];
+                    T maxima[REDUCTION_LANES];
+                    std::fill(minima, minima + REDUCTION_LANES, data[0]);
+                    std::fill(maxima, maxima + REDUCTION_LANES, data[0]);
+                    reduceColumns(data, size, [&](std::size_t k, const T& x)
+                    {
+                        minima[k] = x < minima[k] ? x : minima[k];
+                        maxima[k] = maxima[k] < x ? x : maxima[k];
+                    });
+                    
+                    minimum = std::min<double>(count == 0 ? minima[0] : minimum, *std::min_element(minima, minima + REDUCTION_LANES));
+                    maximum = std::max<double>(count == 0 ? maxima[0] : maximum, *std::max_element(maxima, maxima + REDUCTION_LANES));
+                    break;
+                }
+            }
+            
+            count += size;
+        }
+        
+        //! Second pass, normalize the next chunk of the signal, input and output may be the same
+        /*! @throw std::runtime_error if the signal can't be normalized, see getFactor() */
+        void process(const T* in, T* out, std::size_t size) const
+        {
+            rescale(in, out, size, static_cast<T>(getOffset()), static_cast<T>(getFactor()));
+        }
+        
+        //! The factor the second pass scales by, after subtracting the offset
+        /*! @throw std::runtime_error if the peak, area, RMS, standard deviation, range or norm of the
+                   signal equals zero, or the peak is not a number */
+        double getFactor() const
+        {
+            switch (mode)
+            {
+                case NormalizationMode::PEAK:
+                    if (peak != peak)
+                        throw std::runtime_error("peak is not a number");
+                    
+                    if (!peak)
+                        throw std::runtime_error("peak equals zero");
+                    
+                    return 1.0 / peak;
+                case NormalizationMode::AREA:
+                    if (!area)
+                        throw std::runtime_error("area equals zero");
+                    
+                    return 1.0 / area;
+                case NormalizationMode::RMS:
+                    if (!sumOfSquares)
+                        throw std::runtime_error("rms equals zero");
+                    
+                    return 1.0 / getRms();
+                case NormalizationMode::Z_SCORE:
+                    if (!(getStandardDeviation() > 0))
+                        throw std::runtime_error("standard deviation equals zero");
+                    
+                    return 1.0 / getStandardDeviation();
+                case NormalizationMode::MIN_MAX:
+                    if (!(maximum > minimum))
+                        throw std::runtime_error("range equals zero");
+                    
+                    return 1.0 / (maximum - minimum);
+                case NormalizationMode::L2:
+                    if (!sumOfSquares)
+                        throw std::runtime_error("norm equals zero");
+                    
+                    return 1.0 / std::sqrt(sumOfSquares);
+            }
+            
+            return 1;
+        }
+        
+        //! The offset the second pass subtracts, the mean for z-score and the minimum for min-max
+        double getOffset() const
+        {
+            switch (mode)
+            {
+                case NormalizationMode::Z_SCORE: return getMean();
+                case NormalizationMode::MIN_MAX: return minimum;
+                default: return 0;
+            }
+        }
+        
+        //! Forget the analyzed signal, to start over with another one
+        void reset()
+        {
+            peak = 0;
+            area = 0;
+            sumOfSquares = 0;
+            shift = 0;
+            shiftedSum = 0;
+            shiftedSumOfSquares = 0;
+            minimum = 0;
+            maximum = 0;
+            count = 0;
+        }
+        
+        //! The largest absolute value analyzed so far, in peak mode
+        double getPeak() const { return peak; }
+        
+        //! The sum of the values analyzed so far, in area mode
+        double getArea() const { return area; }
+        
+        //! The root mean square of the values analyzed so far, in RMS or L2 mode
+        double getRms() const { return count > 0 ? std::sqrt(sumOfSquares / count) : 0; }
+        
+        //! The mean of the values analyzed so far, in z-score mode
+        double getMean() const { return count > 0 ? shift + shiftedSum / count : 0; }
+        
+        //! The (population) standard deviation of the values analyzed so far, in z-score mode
+        double getStandardDeviation() const
+        {
+            if (count == 0)
+                return 0;
+            
+            const auto mean = shiftedSum / count;
+            return std::sqrt(std::max(shiftedSumOfSquares / count - mean * mean, 0.0));
+        }
+        
+        //! The smallest value analyzed so far, in min-max mode
+        double getMinimum() const { return minimum; }
+        
+        //! The largest value analyzed so far, in min-max mode
+        double getMaximum() const { return maximum; }
+        
+    private:
+        //! The quantity to normalize
+        NormalizationMode mode = NormalizationMode::PEAK;
+        
+        //! The statistics so far, in double so long signals don't lose precision
+        double peak = 0;
+        double area = 0;
+        double sumOfSquares = 0;
+        double minimum = 0;
+        double maximum = 0;
+        
+        //! The first sample, and the sums of the deviations from it and their squares
+        double shift = 0;
+        double shiftedSum = 0;
+        double shiftedSumOfSquares = 0;
+        
+        //! The number of samples analyzed
+        std::size_t count = 0;
+    };
+    
+    //! Normalize a signal so its root mean square equals a target, input and output may be the same
+    /*! @throw std::runtime_error if the signal is silent */
+    template <typename T>
+    void normalizeRms(const T* in, T* out, std::size_t size, const T& target = 1)
+    {
+        StreamingNormalizer<T> normalizer(NormalizationMode::RMS);
+        normalizer.analyze(in, size);
+        rescale(in, out, size, T{0}, static_cast<T>(normalizer.getFactor() * target));
+    }
+    
+    //! Normalize a signal to a mean of zero and a standard deviation of one, input and output may be the same
+    /*! @throw std::runtime_error if the signal is constant */
+    template <typename T>
+    void normalizeZScore(const T* in, T* out, std::size_t size)
+    {
+        StreamingNormalizer<T> normalizer(NormalizationMode::Z_SCORE);
+        normalizer.analyze(in, size);
+        normalizer.process(in, out, size);
+    }
+    
+    //! Map the minimum of a signal onto low and the maximum onto high, input and output may be the same
+    /*! @throw std::runtime_error if the signal is constant */
+    template <typename T>
+    void normalizeMinMax(const T* in, T* out, std::size_t size, const T& low = 0, const T& high = 1)
+    {
+        StreamingNormalizer<T> normalizer(NormalizationMode::MIN_MAX);
+        normalizer.analyze(in, size);
+        rescale(in, out, size, static_cast<T>(normalizer.getOffset()), static_cast<T>(normalizer.getFactor() * (high - low)), low);
+    }
+    
+    //! Normalize a signal so its Euclidean norm equals one, input and output may be the same
+    /*! @throw std::runtime_error if the signal is silent */
+    template <typename T>
+    void normalizeL2(const T* in, T* out, std::size_t size)
+    {
+        StreamingNormalizer<T> normalizer(NormalizationMode::L2);
+        normalizer.analyze(in, size);
+        normalizer.process(in, out, size);
+    }
+    
+    //! Normalize every row of a row-major matrix, using multiple threads
+    /*! The rows are divided into contiguous runs, one per thread, and every row is normalized on its
+        own, in two passes. Input and output may be the same.
+        @param normalizer Called as normalizer(in, out, size) per row, like a lambda calling normalizeMinMax()
+        @param threadCount The number of threads to use, or 0 for the hardware concurrency
+        @throw The first exception thrown by any row, after all threads finished */
+    template <typename T, typename Normalizer>
+    void normalizeRows(const T* in, T* out, std::size_t rowCount, std::size_t rowSize, Normalizer normalizer, std::size_t threadCount = 0)
+    {
+        if (threadCount == 0)
+            threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        
+        threadCount = std::min(threadCount, rowCount);
+        
+        std::vector<std::exception_ptr> errors(threadCount);
+        const auto normalizeRun = [&](std::size_t thread)
+        {
+            try
+            {
+                for (auto row = rowCount * thread / threadCount; row < rowCount * (thread + 1) / threadCount; ++row)
+                    normalizer(in + row * rowSize, out + row * rowSize, rowSize);
+            }
+            catch (...)
+            {
+                errors[thread] = std::current_exception();
+            }
+        };
+        
+        std::vector<std::thread> threads;
+        for (std::size_t thread = 1; thread < threadCount; ++thread)
+            threads.emplace_back(normalizeRun, thread);
+        
+        if (threadCount > 0)
+            normalizeRun(0);
+        
+        for (auto& thread : threads)
+            thread.join();
+        
+        for (auto& error : errors)
+        {
+            if (error)
+                std::rethrow_exception(error);
+        }
+    }
+    
+    //! Normalize every row of a row-major matrix to one of the normalization modes, using multiple threads
+    /*! Min-max maps onto [0, 1], the other modes bring their quantity to one
+        @param threadCount The number of threads to use, or 0 for the hardware concurrency
+        @throw std::runtime_error if any row can't be normalized */
+    template <typename T>
+    void normalizeRows(const T* in, T* out, std::size_t rowCount, std::size_t rowSize, NormalizationMode mode, std::size_t threadCount = 0)
+    {
+        normalizeRows(in, out, rowCount, rowSize, [mode](const T* rowIn, T* rowOut, std::size_t size)
+        {
+            StreamingNormalizer<T> normalizer(mode);
+            normalizer.analyze(rowIn, size);
+            normalizer.process(rowIn, rowOut, size);
+        }, threadCount);
+    }
+    
+    //! Real-time peak limiter, looking ahead to reduce the gain before a peak arrives
+    /*! The signal is delayed by the look-ahead, while the gain follows the lowest gain needed
+        anywhere in the look-ahead window, smoothed by a moving average over that same window. That
+        way the gain is fully down by the time a peak leaves the delay, without ever overshooting
+        the ceiling, and without the distortion of clipping. Once past, the gain recovers with a
+        one-pole release.
+        
+        With a maximum gain above 1, quiet passages are boosted too, turning the limiter into a
+        look-ahead peak normalizer.
+        
+        @code{cpp}
+        // 5 ms look-ahead and 100 ms release at 48 kHz, limiting to -1 dBFS
+        LookAheadLimiter<float> limiter(240, 0.891, 4800);
+        limiter.process(block.data(), block.data(), block.size());
+        @endcode */
+    template <typename T>
+    class LookAheadLimiter
+    {
+    public:
+        //! Construct the limiter
+        /*! @param lookAhead The look-ahead, and thereby latency, in samples
+            @param ceiling The highest absolute value to output
+            @param release The number of samples in which the gain recovers by about 63%
+            @param maxGain The highest gain applied, 1 for a limiter or higher for a normalizer
+            @throw std::invalid_argument if ceiling <= 0 or maxGain <= 0 */
+        LookAheadLimiter(std::size_t lookAhead, const T& ceiling = 1, std::size_t release = 0, const T& maxGain = 1) :
+            ceiling(ceiling),
+            maxGain(maxGain),
+            releaseCoefficient(release > 0 ? static_cast<T>(std::exp(-1.0 / release)) : T{0})
+        {
+            if (ceiling <= 0)
+                throw std::invalid_argument("ceiling <= 0");
+            
+            if (maxGain <= 0)
+                throw std::invalid_argument("maxGain <= 0");
+            
+            const auto window = lookAhead + 1;
+            delay.resize(window);
+            averages.resize(window);
+            minima.resize(window);
+            minimumTimes.resize(window);
+            reset();
+        }
+        
+        //! Limit a block of samples, input and output may be the same
+        void process(const T* in, T* out, std::size_t size)
+        {
+            const auto window = delay.size();
+            for (std::size_t i = 0; i < size; ++i, ++time)
+            {
+                // The gain needed for the incoming sample
+                const T x = in[i];
+                const T magnitude = std::abs(x);
+                const T needed = magnitude * maxGain > ceiling ? ceiling / magnitude : maxGain;
+                
+                // The minimum over the window, kept as a queue of ascending gains with their times
+                if (count > 0 && minimumTimes[front] + window <= time)
+                {
+                    front = (front + 1) % window;
+                    --count;
+                }
+                
+                while (count > 0 && minima[back()] >= needed)
+                    --count;
+                
+                minima[(front + count) % window] = needed;
+                minimumTimes[(front + count) % window] = time;
+                ++count;
+                
+                // The moving average of the minimum, which is fully down by the time a peak leaves the delay
+                const auto slot = time % window;
+                sum += minima[front] - averages[slot];
+                averages[slot] = minima[front];
+                const auto target = static_cast<T>(sum / window);
+                
+                // Follow a drop immediately, as the average already ramps it, and release gradually
+                gain = target < gain ? target : target + (gain - target) * releaseCoefficient;
+                
+                delay[slot] = x;
+                out[i] = delay[(time + 1) % window] * gain;
+            }
+        }
+        
+        //! Clear the delay and restore the gain
+        void reset()
+        {
+            std::fill(delay.begin(), delay.end(), 0);
+            std::fill(averages.begin(), averages.end(), maxGain);
+            sum = static_cast<double>(maxGain) * averages.size();
+            gain = maxGain;
+            front = 0;
+            count = 0;
+            time = 0;
+        }
+        
+        //! The latency in samples, being the look-ahead
+        std::size_t getLatency() const { return delay.size() - 1; }
+        
+        //! The gain applied to the last sample
+        T getGain() const { return gain; }
+        
+    private:
+        //! The index of the newest minimum in the queue
+        std::size_t back() const { return (front + count - 1) % delay.size(); }
+        
+    private:
+        //! The highest absolute value to output
+        T ceiling = 1;
+        
+        //! The highest gain applied
+        T maxGain = 1;
+        
+        //! The one-pole coefficient of the release
+        T releaseCoefficient = 0;
+        
+        //! The delayed input
+        std::vector<T> delay;
+        
+        //! The window of minimum gains being averaged, and their sum
+        std::vector<T> averages;
+        double sum = 0;
+        
+        //! The queue of ascending minimum gains in the window, and the times at which they entered
+        std::vector<T> minima;
+        std::vector<std::size_t> minimumTimes;
+        std::size_t front = 0;
+        std::size_t count = 0;
+        
+        //! The number of samples processed
+        std::size_t time = 0;
+        
+        //! The current gain
+        T gain = 1;
+    };
 }
 
 #endif
@@ -0,0 +1,369 @@
+//
+//  oversample.hpp
+//  Math
+//
+//  Copyright © 2015-2016 Dsperados (info@dsperados.com). All rights reserved.
+//  Licensed under the BSD 3-clause license.
+//
+
+#ifndef DSPERADOS_MATH_OVERSAMPLE_HPP
+#define DSPERADOS_MATH_OVERSAMPLE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "constants.hpp"
+#include "sigmoid.hpp"
+#include "utility.hpp"
+
+namespace math
+{
+    //! The default number of non-zero half-band coefficients per side, for the stage at the base rate
+    constexpr std::size_t HALFBAND_COEFFICIENT_COUNT = 16;
+    
+    //! The zeroth order modified Bessel function of the first kind
+    inline double besselI0(double x)
+    {
+        const auto quarterSquare = x * x / 4;
+        double term = 1;
+        double sum = 1;
+        for (std::size_t k = 1; term > sum * 1e-17; ++k)
+        {
+            term *= quarterSquare / (k * k);
+            sum += term;
+        }
+        
+        return sum;
+    }
+    
+    //! Design a linear-phase half-band lowpass filter, as used for resampling by a factor of 2
+    /*! A Kaiser windowed sinc with 4 * coefficientCount - 1 taps. Every other tap of a half-band
+        filter is 0, except for the center tap, which is 0.5. Only the remaining non-zero taps are
+        returned, in order, normalized so the filter has unity gain at DC.
+        @param coefficientCount The number of non-zero taps on each side of the center
+        @param beta The Kaiser window shape, higher trades a wider transition band for more stopband attenuation
+        @throw std::invalid_argument if coefficientCount == 0 */
+    inline std::vector<double> designHalfband(std::size_t coefficientCount, double beta = 9)
+    {
+        if (coefficientCount == 0)
+            throw std::invalid_argument("coefficientCount == 0");
+        
+        // The taps lie at odd offsets from the center, 2 * coefficientCount - 1 at most
+        const auto reach = static_cast<double>(2 * coefficientCount);
+        std::vector<double> coefficients(2 * coefficientCount);
+        double sum = 0;
+        for (std::size_t i = 0; i < coefficients.size(); ++i)
+        {
+            const auto offset = 2 * static_cast<double>(i) - (reach - 1);
+            const auto ratio = offset / reach;
+            const auto window = besselI0(beta * std::sqrt(1 - ratio * ratio)) / besselI0(beta);
+            coefficients[i] = std::sin(PI<double> * offset / 2) / (PI<double> * offset) * window;
+            sum += coefficients[i];
+        }
+        
+        for (auto& coefficient : coefficients)
+            coefficient *= 0.5 / sum;
+        
+        return coefficients;
+    }
+    
+    //! Upsampler by a factor of 2, using a polyphase half-band filter
+    /*! The zero-stuffed input is never formed: one output phase is a short FIR over the input, the
+        other phase is the input delayed (the center tap). The FIR loops over the taps on the outside
+        and the samples on the inside, so it vectorizes across samples. All buffers are allocated at
+        construction; larger blocks are processed in chunks. */
+    template <typename T>
+    class HalfbandUpsampler
+    {
+    public:
+        //! Construct the upsampler
+        /*! @param coefficients The non-zero taps as returned by designHalfband()
+            @param maxBlockSize The largest number of input samples processed in one go */
+        HalfbandUpsampler(const std::vector<double>& coefficients, std::size_t maxBlockSize) :
+            maxBlockSize(maxBlockSize)
+        {
+            if (coefficients.empty() || coefficients.size() % 2)
+                throw std::invalid_argument("coefficient count is not a positive, even number");
+            
+            if (maxBlockSize == 0)
+                throw std::invalid_argument("maxBlockSize == 0");
+            
+            // Zero stuffing halves the gain, so double it back
+            for (auto coefficient : coefficients)
+                taps.emplace_back(static_cast<T>(2 * coefficient));
+            
+            buffer.assign(taps.size() - 1 + maxBlockSize, 0);
+            filtered.resize(maxBlockSize);
+        }
+        
+        //! Upsample a block, writing twice the number of samples to the output
+        void process(const T* in, T* out, std::size_t size)
+        {
+            const auto history = taps.size() - 1;
+            const auto delay = taps.size() / 2 - 1;
+            for (std::size_t offset = 0; offset < size; offset += maxBlockSize)
+            {
+                const auto count = std::min(size - offset, maxBlockSize);
+                std::copy(in + offset, in + offset + count, buffer.begin() + history);
+                
+                std::fill(filtered.begin(), filtered.begin() + count, 0);
+                for (std::size_t i = 0; i < taps.size(); ++i)
+                {
+                    const auto tap = taps[i];
+                    const auto samples = &buffer[i];
+                    for (std::size_t n = 0; n < count; ++n)
+                        filtered[n] += tap * samples[n];
+                }
+                
+                // Interleave the filtered phase with the delayed phase
+                for (std::size_t n = 0; n < count; ++n)
+                {
+                    out[2 * (offset + n)] = filtered[n];
+                    out[2 * (offset + n) + 1] = buffer[history + n - delay];
+                }
+                
+                std::copy(buffer.begin() + count, buffer.begin() + count + history, buffer.begin());
+            }
+        }
+        
+        //! Clear the filter state
+        void reset()
+        {
+            std::fill(buffer.begin(), buffer.end(), 0);
+        }
+        
+        //! The delay introduced, in output samples
+        std::size_t getLatency() const { return taps.size() - 1; }
+        
+    private:
+        //! The non-zero taps besides the center tap, scaled by 2
+        std::vector<T> taps;
+        
+        //! The input history followed by the current chunk
+        std::vector<T> buffer;
+        
+        //! The output of the FIR phase for the current chunk
+        std::vector<T> filtered;
+        
+        //! The largest chunk of input processed at once
+        std::size_t maxBlockSize = 0;
+    };
+    
+    //! Downsampler by a factor of 2, using a polyphase half-band filter
+    /*! Only every other output of the half-band filter is computed. The input is split into its even
+        and odd phases: the even phase goes through a short FIR, the odd phase only meets the center
+        tap. Vectorizes and allocates like HalfbandUpsampler. */
+    template <typename T>
+    class HalfbandDownsampler
+    {
+    public:
+        //! Construct the downsampler
+        /*! @param coefficients The non-zero taps as returned by designHalfband()
+            @param maxBlockSize The largest number of output samples processed in one go */
+        HalfbandDownsampler(const std::vector<double>& coefficients, std::size_t maxBlockSize) :
+            maxBlockSize(maxBlockSize)
+        {
+            if (coefficients.empty() || coefficients.size() % 2)
+                throw std::invalid_argument("coefficient count is not a positive, even number");
+            
+            if (maxBlockSize == 0)
+                throw std::invalid_argument("maxBlockSize == 0");
+            
+            taps.assign(coefficients.begin(), coefficients.end());
+            even.assign(taps.size() - 1 + maxBlockSize, 0);
+            odd.assign(taps.size() / 2 + maxBlockSize, 0);
+        }
+        
+        //! Downsample a block, reading twice the number of samples from the input
+        /*! @param size The number of output samples */
+        void process(const T* in, T* out, std::size_t size)
+        {
+            const auto evenHistory = taps.size() - 1;
+            const auto oddHistory = taps.size() / 2;
+            for (std::size_t offset = 0; offset < size; offset += maxBlockSize)
+            {
+                const auto count = std::min(size - offset, maxBlockSize);
+                for (std::size_t n = 0; n < count; ++n)
+                {
+                    even[evenHistory + n] = in[2 * (offset + n)];
+                    odd[oddHistory + n] = in[2 * (offset + n) + 1];
+                }
+                
+                // The odd phase only meets the center tap
+                for (std::size_t n = 0; n < count; ++n)
+                    out[offset + n] = T{0.5} * odd[n];
+                
+                for (std::size_t i = 0; i < taps.size(); ++i)
+                {
+                    const auto tap = taps[i];
+                    const auto samples = &even[i];
+                    for (std::size_t n = 0; n < count; ++n)
+                        out[offset + n] += tap * samples[n];
+                }
+                
+                std::copy(even.begin() + count, even.begin() + count + evenHistory, even.begin());
+                std::copy(odd.begin() + count, odd.begin() + count + oddHistory, odd.begin());
+            }
+        }
+        
+        //! Clear the filter state
+        void reset()
+        {
+            std::fill(even.begin(), even.end(), 0);
+            std::fill(odd.begin(), odd.end(), 0);
+        }
+        
+        //! The delay introduced, in input samples
+        std::size_t getLatency() const { return taps.size() - 1; }
+        
+    private:
+        //! The non-zero taps besides the center tap
+        std::vector<T> taps;
+        
+        //! The history and current chunk of the even input phase
+        std::vector<T> even;
+        
+        //! The history and current chunk of the odd input phase
+        std::vector<T> odd;
+        
+        //! The largest chunk of output processed at once
+        std::size_t maxBlockSize = 0;
+    };
+    
+    //! Waveshaper running at 2, 4 or 8 times the sample rate, to suppress aliasing
+    /*! Upsamples by cascaded half-band stages, shapes, and downsamples back through the mirrored
+        stages. The stages beyond the first only need to keep the original band, so they use half the
+        coefficients. All buffers are allocated at construction, so processing never allocates.
+        
+        @code{cpp}
+        OversampledWaveshaper<float, SigmoidTanShape, FastMath<>> shaper(4, 4, 8, 512);
+        shaper.process(input.data(), output.data(), input.size());
+        
+        // Delay a dry signal by the same amount to mix it in
+        auto latency = shaper.getLatency();
+        @endcode */
+    template <typename T, class Shape, class Math = StandardMath>
+    class OversampledWaveshaper
+    {
+    public:
+        //! Construct the waveshaper
+        /*! @param oversamplingFactor 1, 2, 4 or 8
+            @param maxBlockSize The largest number of samples processed in one go, larger blocks are split up
+            @param coefficientCount The number of non-zero half-band taps per side of the first stage
+            @throw std::invalid_argument if the oversampling factor is not 1, 2, 4 or 8, or maxBlockSize == 0
+            @throw std::runtime_error if either factor <= 0 */
+        OversampledWaveshaper(double negativeFactor, double positiveFactor, std::size_t oversamplingFactor, std::size_t maxBlockSize = 512, std::size_t coefficientCount = HALFBAND_COEFFICIENT_COUNT) :
+            shaper(negativeFactor, positiveFactor),
+            oversamplingFactor(oversamplingFactor),
+            maxBlockSize(maxBlockSize)
+        {
+            if (oversamplingFactor == 0 || oversamplingFactor > 8 || !isPowerOf2(oversamplingFactor))
+                throw std::invalid_argument("oversampling factor is not 1, 2, 4 or 8");
+            
+            if (maxBlockSize == 0)
+                throw std::invalid_argument("maxBlockSize == 0");
+            
+            const auto first = designHalfband(coefficientCount);
+            const auto rest = designHalfband(std::max<std::size_t>(coefficientCount / 2, 1));
+            for (std::size_t rate = 1; rate < oversamplingFactor; rate *= 2)
+            {
+                const auto& coefficients = rate == 1 ? first : rest;
+                upsamplers.emplace_back(coefficients, maxBlockSize * rate);
+                downsamplers.emplace_back(coefficients, maxBlockSize * rate);
+                latency += 2.0 * upsamplers.back().getLatency() / (rate * 2);
+            }
+            
+            front.resize(maxBlockSize * oversamplingFactor);
+            back.resize(maxBlockSize * oversamplingFactor);
+        }
+        
+        //! Shape a block of samples, input and output may be the same
+        void process(const T* in, T* out, std::size_t size)
+        {
+            if (upsamplers.empty())
+            {
+                shaper.process(in, out, size);
+                return;
+            }
+            
+            for (std::size_t offset = 0; offset < size; offset += maxBlockSize)
+            {
+                const auto count = std::min(size - offset, maxBlockSize);
+                
+                // Up, ping-ponging between the buffers
+                auto source = in + offset;
+                auto destination = front.data();
+                auto spare = back.data();
+                for (std::size_t stage = 0; stage < upsamplers.size(); ++stage)
+                {
+                    upsamplers[stage].process(source, destination, count << stage);
+                    source = destination;
+                    std::swap(destination, spare);
+                }
+                
+                shaper.process(source, spare, count * oversamplingFactor);
+                
+                // And back down, the last stage writing to the output
+                for (auto stage = downsamplers.size(); stage-- > 0;)
+                {
+                    auto target = stage == 0 ? out + offset : destination;
+                    downsamplers[stage].process(spare, target, count << stage);
+                    destination = spare;
+                    spare = target;
+                }
+            }
+        }
+        
+        //! Change the factors, which are reached at the end of the next processed block
+        /*! @throw std::runtime_error if either factor <= 0 */
+        void setFactors(double negativeFactor, double positiveFactor)
+        {
+            shaper.setFactors(negativeFactor, positiveFactor);
+        }
+        
+        //! Clear the filter state
+        void reset()
+        {
+            for (auto& upsampler : upsamplers)
+                upsampler.reset();
+            
+            for (auto& downsampler : downsamplers)
+                downsampler.reset();
+        }
+        
+        //! The delay introduced by the resampling filters, in samples at the base rate
+        /*! Can be a fraction of a sample at oversampling factors of 4 and 8 */
+        double getLatency() const { return latency; }
+        
+        //! The oversampling factor
+        std::size_t getOversamplingFactor() const { return oversamplingFactor; }
+        
+    private:
+        //! The waveshaper running at the oversampled rate
+        Waveshaper<T, Shape, Math> shaper;
+        
+        //! The upsampling stages, from the base rate up
+        std::vector<HalfbandUpsampler<T>> upsamplers;
+        
+        //! The downsampling stages, from the base rate up
+        std::vector<HalfbandDownsampler<T>> downsamplers;
+        
+        //! The oversampled buffers, alternating between input and output per stage
+        std::vector<T> front;
+        std::vector<T> back;
+        
+        //! The oversampling factor
+        std::size_t oversamplingFactor = 1;
+        
+        //! The largest number of base rate samples processed at once
+        std::size_t maxBlockSize = 0;
+        
+        //! The total resampling latency, in base rate samples
+        double latency = 0;
+    };
+}
+
+#endif
@@ -9,8 +9,16 @@
 #ifndef DSPERADOS_MATH_RANDOM_HPP
 #define DSPERADOS_MATH_RANDOM_HPP
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
 #include <random>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
@@ -32,15 +40,752 @@ namespace math
         return std::uniform_real_distribution<T>(a, b)(engine);
     }
     
+    //! Rotate the bits of a word to the left
+    template <typename T>
+    constexpr T rotateLeft(T x, unsigned int bits)
+    {
+        return (x << bits) | (x >> (std::numeric_limits<T>::digits - bits));
+    }
+    
+    //! SplitMix64 step, used to expand a single seed into a larger engine state
+    inline std::uint64_t splitMix64(std::uint64_t& state)
+    {
+        auto z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    
+    //! The xoshiro256** engine by Blackman and Vigna
+    /*! A fast 64-bit engine with 256 bits of state and a period of 2^256 - 1. Use jump() to split off
+        non-overlapping sequences of 2^128 numbers for parallel use. Satisfies UniformRandomBitGenerator. */
+    class Xoshiro256StarStar
+    {
+    public:
+        using result_type = std::uint64_t;
+        
+    public:
+        //! Construct the engine, expanding the seed into the full state using SplitMix64
+        Xoshiro256StarStar(std::uint64_t seed = 0)
+        {
+            for (auto& word : state)
+                word = splitMix64(seed);
+        }
+        
+        //! Generate the next number
+        result_type operator()()
+        {
+            const auto result = rotateLeft(state[1] * 5, 7) * 9;
+            const auto t = state[1] << 17;
+            
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = rotateLeft(state[3], 45);
+            
+            return result;
+        }
+        
+        //! Advance the engine by a given number of steps
+        void discard(unsigned long long steps)
+        {
+            while (steps--)
+                (*this)();
+        }
+        
+        //! Advance the engine by 2^128 steps
+        void jump()
+        {
+            jump({0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull});
+        }
+        
+        //! Advance the engine by 2^192 steps
+        void longJump()
+        {
+            jump({0x76E15D3EFEFDCBBFull, 0xC5004E441C522FB3ull, 0x77710069854EE241ull, 0x39109BB02ACBE635ull});
+        }
+        
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+        
+    private:
+        //! Apply a jump polynomial to the state
+        void jump(const std::array<std::uint64_t, 4>& polynomial)
+        {
+            std::array<std::uint64_t, 4> result = {0, 0, 0, 0};
+            for (auto word : polynomial)
+            {
+                for (unsigned int bit = 0; bit < 64; ++bit)
+                {
+                    if (word & (std::uint64_t{1} << bit))
+                    {
+                        for (std::size_t i = 0; i < 4; ++i)
+                            result[i] ^= state[i];
+                    }
+                    
+                    (*this)();
+                }
+            }
+            
+            state = result;
+        }
+        
+    private:
+        std::array<std::uint64_t, 4> state;
+    };
+    
+    //! The PCG32 engine by O'Neill (XSH-RR output on a 64-bit LCG)
+    /*! A small 32-bit engine with 128 bits of state, supporting 2^63 independent streams and
+        logarithmic-time discard(). Satisfies UniformRandomBitGenerator. */
+    class Pcg32
+    {
+    public:
+        using result_type = std::uint32_t;
+        
+    public:
+        //! Construct the engine for a seed and a stream
+        Pcg32(std::uint64_t seed = 0x853C49E6748FEA9Bull, std::uint64_t stream = 0xDA3E39CB94B95BDBull) :
+            increment((stream << 1) | 1)
+        {
+            (*this)();
+            state += seed;
+            (*this)();
+        }
+        
+        //! Generate the next number
+        result_type operator()()
+        {
+            const auto old = state;
+            state = old * MULTIPLIER + increment;
+            
+            const auto shifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+            const auto rotation = static_cast<unsigned int>(old >> 59);
+            return (shifted >> rotation) | (shifted << ((0u - rotation) & 31));
+        }
+        
+        //! Advance the engine by a given number of steps in logarithmic time
+        void discard(unsigned long long steps)
+        {
+            // Square the LCG step repeatedly, applying it for each set bit of steps
+            std::uint64_t multiplier = MULTIPLIER;
+            std::uint64_t addend = increment;
+            std::uint64_t accumulatedMultiplier = 1;
+            std::uint64_t accumulatedAddend = 0;
+            
+            for (; steps > 0; steps >>= 1)
+            {
+                if (steps & 1)
+                {
+                    accumulatedMultiplier *= multiplier;
+                    accumulatedAddend = accumulatedAddend * multiplier + addend;
+                }
+                
+                addend = (multiplier + 1) * addend;
+                multiplier *= multiplier;
+            }
+            
+            state = accumulatedMultiplier * state + accumulatedAddend;
+        }
+        
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+        
+    private:
+        static constexpr std::uint64_t MULTIPLIER = 6364136223846793005ull;
+        
+        std::uint64_t state = 0;
+        std::uint64_t increment = 1;
+    };
+    
+    //! The Philox4x32-10 counter-based engine by Salmon et al.
+    /*! Every block of four numbers is a pure function of a 128-bit counter and a 64-bit key, so the
+        engine can jump to any position in constant time, and independent streams can be selected
+        with the upper half of the counter. Bulk generation computes eight counters side-by-side, so
+        the rounds vectorize across lanes. Satisfies UniformRandomBitGenerator. */
+    class Philox4x32
+    {
+    public:
+        using result_type = std::uint32_t;
+        
+        //! The number of counters computed side-by-side in bulk generation
+        static constexpr std::size_t LANES = 8;
+        
+    public:
+        //! Construct the engine for a key and a stream
+        Philox4x32(std::uint64_t seed = 0, std::uint64_t stream = 0) :
+            key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)},
+            stream(stream)
+        {
+        }
+        
+        //! Generate the next number
+        result_type operator()()
+        {
+            if (index == 4)
+            {
+                buffer = generateBlock(counter++);
+                index = 0;
+            }
+            
+            return buffer[index++];
+        }
+        
+        //! Generate a range of numbers, computing several blocks side-by-side
+        /*! The output is identical to calling operator() for each element */
+        void generate(std::uint32_t* begin, std::uint32_t* end)
+        {
+            // Drain the buffered block first
+            while (begin != end && index < 4)
+                *begin++ = buffer[index++];
+            
+            while (static_cast<std::size_t>(end - begin) >= 4 * LANES)
+            {
+                generateBlocks(counter, begin);
+                counter += LANES;
+                begin += 4 * LANES;
+            }
+            
+            while (begin != end)
+                *begin++ = (*this)();
+        }
+        
+        //! Advance the engine by a given number of steps in constant time
+        void discard(unsigned long long steps)
+        {
+            seek(position() + steps);
+        }
+        
+        //! Move the engine to an absolute position in its stream
+        void seek(std::uint64_t position)
+        {
+            counter = position / 4;
+            index = 4;
+            
+            if (position % 4 != 0)
+            {
+                buffer = generateBlock(counter++);
+                index = position % 4;
+            }
+        }
+        
+        //! The number of values generated since the start of the stream
+        std::uint64_t position() const
+        {
+            return counter * 4 - (4 - index);
+        }
+        
+        //! Compute the block of four numbers for a position in the stream
+        std::array<std::uint32_t, 4> generateBlock(std::uint64_t block) const
+        {
+            std::array<std::uint32_t, 4> result;
+            generateBlocks<1>(block, result.data());
+            return result;
+        }
+        
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+        
+    private:
+        //! Compute a number of consecutive blocks, in structure-of-arrays form so the rounds vectorize
+        template <std::size_t Lanes = LANES>
+        void generateBlocks(std::uint64_t block, std::uint32_t* out) const
+        {
+            std::uint32_t c0[Lanes], c1[Lanes], c2[Lanes], c3[Lanes];
+            for (std::size_t lane = 0; lane < Lanes; ++lane)
+            {
+                c0[lane] = static_cast<std::uint32_t>(block + lane);
+                c1[lane] = static_cast<std::uint32_t>((block + lane) >> 32);
+                c2[lane] = static_cast<std::uint32_t>(stream);
+                c3[lane] = static_cast<std::uint32_t>(stream >> 32);
+            }
+            
+            auto k0 = key[0];
+            auto k1 = key[1];
+            for (std::size_t round = 0; round < 10; ++round)
+            {
+                for (std::size_t lane = 0; lane < Lanes; ++lane)
+                {
+                    const auto product0 = static_cast<std::uint64_t>(0xD2511F53u) * c0[lane];
+                    const auto product1 = static_cast<std::uint64_t>(0xCD9E8D57u) * c2[lane];
+                    
+                    const auto x0 = static_cast<std::uint32_t>(product1 >> 32) ^ c1[lane] ^ k0;
+                    const auto x2 = static_cast<std::uint32_t>(product0 >> 32) ^ c3[lane] ^ k1;
+                    c1[lane] = static_cast<std::uint32_t>(product1);
+                    c3[lane] = static_cast<std::uint32_t>(product0);
+                    c0[lane] = x0;
+                    c2[lane] = x2;
+                }
+                
+                k0 += 0x9E3779B9u;
+                k1 += 0xBB67AE85u;
+            }
+            
+            for (std::size_t lane = 0; lane < Lanes; ++lane)
+            {
+                out[lane * 4] = c0[lane];
+                out[lane * 4 + 1] = c1[lane];
+                out[lane * 4 + 2] = c2[lane];
+                out[lane * 4 + 3] = c3[lane];
+            }
+        }
+        
+    private:
+        //! The key, derived from the seed
+        std::array<std::uint32_t, 2> key;
+        
+        //! The upper half of the counter, selecting an independent stream
+        std::uint64_t stream = 0;
+        
+        //! The lower half of the counter, the index of the next block to compute
+        std::uint64_t counter = 0;
+        
+        //! The most recently computed block
+        std::array<std::uint32_t, 4> buffer = {0, 0, 0, 0};
+        
+        //! The position of the next number in the buffer
+        std::size_t index = 4;
+    };
+    
+    //! The number of samples converted at once by the block generators
+    constexpr std::size_t RANDOM_BLOCK_SIZE = 256;
+    
+    //! Does an engine produce uniformly distributed 32-bit or 64-bit words?
+    /*! Only those engines can be used directly for bit-trick conversions, others go through the standard distributions */
+    template <typename Engine>
+    constexpr bool producesFullWords()
+    {
+        using Result = typename Engine::result_type;
+        return std::is_unsigned<Result>::value && Engine::min() == 0 &&
+            (Engine::max() == std::numeric_limits<std::uint32_t>::max() || Engine::max() == std::numeric_limits<std::uint64_t>::max());
+    }
+    
+    //! Fill a buffer with uniformly distributed 32-bit words taken from an engine
+    /*! 64-bit engines contribute two words per call. Engines that can generate blocks of words more
+        efficiently overload this function.
+        @warning The engine needs to satisfy producesFullWords() */
+    template <typename Engine>
+    void generateRandomBits(Engine& engine, std::uint32_t* begin, std::uint32_t* end)
+    {
+        static_assert(producesFullWords<Engine>(), "engine doesn't produce full 32-bit or 64-bit words");
+        
+        if (Engine::max() == std::numeric_limits<std::uint32_t>::max())
+        {
+            std::generate(begin, end, [&]{ return static_cast<std::uint32_t>(engine()); });
+            return;
+        }
+        
+        for (; begin != end; ++begin)
+        {
+            const std::uint64_t word = engine();
+            *begin = static_cast<std::uint32_t>(word >> 32);
+            if (++begin == end)
+                break;
+            
+            *begin = static_cast<std::uint32_t>(word);
+        }
+    }
+    
+    //! Fill a buffer with 32-bit words taken from a Philox engine, computing several blocks side-by-side
+    inline void generateRandomBits(Philox4x32& engine, std::uint32_t* begin, std::uint32_t* end)
+    {
+        engine.generate(begin, end);
+    }
+    
+    //! Convert a uniformly distributed 32-bit word into a float in [0, 1)
+    /*! Puts the upper 23 bits in the mantissa of a float in [1, 2), which needs no division or int-to-float conversion */
+    inline float wordToUnitFloat(std::uint32_t word)
+    {
+        const std::uint32_t bits = 0x3F800000u | (word >> 9);
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result - 1.0f;
+    }
+    
+    //! Convert two uniformly distributed 32-bit words into a double in [0, 1)
+    /*! Puts the upper 52 bits in the mantissa of a double in [1, 2), which needs no division or int-to-float conversion */
+    inline double wordsToUnitDouble(std::uint32_t high, std::uint32_t low)
+    {
+        const std::uint64_t bits = 0x3FF0000000000000ull | (((static_cast<std::uint64_t>(high) << 32) | low) >> 12);
+        double result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result - 1.0;
+    }
+    
+    //! Fill a range with random floating-point uniform samples in [a, b)
+    /*! Draws raw words from the engine in blocks, and converts them using the mantissa bit-trick in a
+        separate, vectorizable loop. Engines that don't produce full words fall back to a single
+        std::uniform_real_distribution. */
+    template <typename ForwardIterator, typename Engine, typename Min, typename Max>
+    std::enable_if_t<std::is_floating_point<typename std::iterator_traits<ForwardIterator>::value_type>::value> generateUniformRandom(ForwardIterator begin, ForwardIterator end, const Min& a, const Max& b, Engine& engine)
+    {
+        using T = typename std::iterator_traits<ForwardIterator>::value_type;
+        
+        if constexpr (!producesFullWords<Engine>())
+        {
+            std::uniform_real_distribution<T> distribution(a, b);
+            std::generate(begin, end, [&]{ return distribution(engine); });
+        }
+        else
+        {
+            constexpr std::size_t wordsPerSample = sizeof(T) > sizeof(float) ? 2 : 1;
+            std::uint32_t words[RANDOM_BLOCK_SIZE * wordsPerSample];
+            
+            const T offset = a;
+            const T range = static_cast<T>(b) - static_cast<T>(a);
+            
+            for (auto remaining = static_cast<std::size_t>(std::distance(begin, end)); remaining > 0;)
+            {
+                const auto count = std::min(remaining, RANDOM_BLOCK_SIZE);
+                remaining -= count;
+                
+                generateRandomBits(engine, words, words + count * wordsPerSample);
+                
+                for (std::size_t i = 0; i < count; ++i, ++begin)
+                {
+                    if constexpr (wordsPerSample == 2)
+                        *begin = offset + range * static_cast<T>(wordsToUnitDouble(words[2 * i], words[2 * i + 1]));
+                    else
+                        *begin = offset + range * static_cast<T>(wordToUnitFloat(words[i]));
+                }
+            }
+        }
+    }
+    
+    //! Map a 32-bit word to [0, range) without bias using Lemire's multiply-and-reject method
+    /*! Only needs a division in the rare case that the word falls inside the biased region
+        @param next Function returning a fresh 32-bit word, called on rejection */
+    template <typename Next>
+    std::uint32_t boundWord(std::uint32_t word, std::uint32_t range, Next&& next)
+    {
+        auto product = static_cast<std::uint64_t>(word) * range;
+        auto low = static_cast<std::uint32_t>(product);
+        if (low < range)
+        {
+            const std::uint32_t threshold = (0u - range) % range;
+            while (low < threshold)
+            {
+                product = static_cast<std::uint64_t>(next()) * range;
+                low = static_cast<std::uint32_t>(product);
+            }
+        }
+        
+        return static_cast<std::uint32_t>(product >> 32);
+    }
+    
+    //! Fill a range with random integral uniform samples in [a, b]
+    /*! Draws raw words from the engine in blocks, and bounds them using Lemire's method. Ranges
+        wider than 32 bits and engines that don't produce full words fall back to a single
+        std::uniform_int_distribution. */
+    template <typename ForwardIterator, typename Engine, typename Min, typename Max>
+    std::enable_if_t<std::is_integral<typename std::iterator_traits<ForwardIterator>::value_type>::value> generateUniformRandom(ForwardIterator begin, ForwardIterator end, const Min& a, const Max& b, Engine& engine)
+    {
+        using T = typename std::iterator_traits<ForwardIterator>::value_type;
+        
+        const auto range = static_cast<std::uint64_t>(static_cast<std::int64_t>(b) - static_cast<std::int64_t>(a)) + 1;
+        
+        if constexpr (producesFullWords<Engine>())
+        {
+            if (range <= (std::uint64_t{1} << 32))
+            {
+                std::uint32_t words[RANDOM_BLOCK_SIZE];
+                const auto next = [&]{ std::uint32_t word; generateRandomBits(engine, &word, &word + 1); return word; };
+                
+                for (auto remaining = static_cast<std::size_t>(std::distance(begin, end)); remaining > 0;)
+                {
+                    const auto count = std::min(remaining, RANDOM_BLOCK_SIZE);
+                    remaining -= count;
+                    
+                    generateRandomBits(engine, words, words + count);
+                    
+                    // A range of 2^32 wraps to 0 and takes the words as they are
+                    for (std::size_t i = 0; i < count; ++i, ++begin)
+                    {
+                        const auto word = static_cast<std::uint32_t>(range) == 0 ? words[i] : boundWord(words[i], static_cast<std::uint32_t>(range), next);
+                        *begin = static_cast<T>(static_cast<std::int64_t>(a) + word);
+                    }
+                }
+                
+                return;
+            }
+        }
+        
+        std::uniform_int_distribution<T> distribution(a, b);
+        std::generate(begin, end, [&]{ return distribution(engine); });
+    }
+    
+    //! Fill a range with random samples from a symmetric triangular distribution on [a, b)
+    /*! Sums two uniform samples, for example to generate TPDF dither with a = -1 and b = 1 */
+    template <typename ForwardIterator, typename Engine, typename Min, typename Max>
+    void generateTriangularRandom(ForwardIterator begin, ForwardIterator end, const Min& a, const Max& b, Engine& engine)
+    {
+        using T = typename std::iterator_traits<ForwardIterator>::value_type;
+        
+        T uniform[RANDOM_BLOCK_SIZE * 2];
+        const T offset = a;
+        const T halfRange = (static_cast<T>(b) - static_cast<T>(a)) / 2;
+        
+        for (auto remaining = static_cast<std::size_t>(std::distance(begin, end)); remaining > 0;)
+        {
+            const auto count = std::min(remaining, RANDOM_BLOCK_SIZE);
+            remaining -= count;
+            
+            generateUniformRandom(uniform, uniform + count * 2, 0, 1, engine);
+            for (std::size_t i = 0; i < count; ++i, ++begin)
+                *begin = offset + halfRange * (uniform[2 * i] + uniform[2 * i + 1]);
+        }
+    }
+    
+    //! Fill a range with random samples from an exponential distribution
+    /*! Transforms uniform samples in blocks using the inverse cumulative distribution -log(1 - u) / lambda */
+    template <typename ForwardIterator, typename Engine>
+    void generateExponentialRandom(ForwardIterator begin, ForwardIterator end, double lambda, Engine& engine)
+    {
+        using T = typename std::iterator_traits<ForwardIterator>::value_type;
+        
+        T uniform[RANDOM_BLOCK_SIZE];
+        const T scale = -1 / lambda;
+        
+        for (auto remaining = static_cast<std::size_t>(std::distance(begin, end)); remaining > 0;)
+        {
+            const auto count = std::min(remaining, RANDOM_BLOCK_SIZE);
+            remaining -= count;
+            
+            generateUniformRandom(uniform, uniform + count, 0, 1, engine);
+            for (std::size_t i = 0; i < count; ++i, ++begin)
+                *begin = scale * std::log(1 - uniform[i]);
+        }
+    }
+    
+    //! Fill a range with random samples from a Laplace distribution
+    /*! Transforms uniform samples in blocks using the inverse cumulative distribution, choosing the
+        side of the mean without a branch */
+    template <typename ForwardIterator, typename Engine>
+    void generateLaplaceRandom(ForwardIterator begin, ForwardIterator end, double mean, double scale, Engine& engine)
+    {
+        using T = typename std::iterator_traits<ForwardIterator>::value_type;
+        
+        T uniform[RANDOM_BLOCK_SIZE];
+        
+        for (auto remaining = static_cast<std::size_t>(std::distance(begin, end)); remaining > 0;)
+        {
+            const auto count = std::min(remaining, RANDOM_BLOCK_SIZE);
+            remaining -= count;
+            
+            generateUniformRandom(uniform, uniform + count, 0, 1, engine);
+            for (std::size_t i = 0; i < count; ++i, ++begin)
+            {
+                // Both halves map to a uniform sample in (0, 0.5], so the logarithm stays finite
+                const auto u = uniform[i];
+                const T sign = u < T{0.5} ? 1 : -1;
+                const T distance = u < T{0.5} ? T{0.5} - u : 1 - u;
+                *begin = static_cast<T>(mean) + sign * static_cast<T>(scale) * std::log(2 * distance);
+            }
+        }
+    }
+    
+    //! The lookup tables for 128-layer ziggurat sampling of the normal distribution
+    /*! Computed once, following Marsaglia and Tsang, "The Ziggurat Method for Generating Random Variables" (2000) */
+    struct GaussianZiggurat
+    {
+        GaussianZiggurat()
+        {
+            const double m = 2147483648.0;
+            const double v = 9.91256303526217e-3;
+            double d = RIGHT;
+            double t = d;
+            const double q = v / std::exp(-0.5 * d * d);
+            
+            k[0] = static_cast<std::uint32_t>((d / q) * m);
+            k[1] = 0;
+            w[0] = q / m;
+            w[127] = d / m;
+            f[0] = 1;
+            f[127] = std::exp(-0.5 * d * d);
+            
+            for (int i = 126; i >= 1; --i)
+            {
+                d = std::sqrt(-2 * std::log(v / d + std::exp(-0.5 * d * d)));
+                k[i + 1] = static_cast<std::uint32_t>((d / t) * m);
+                t = d;
+                f[i] = std::exp(-0.5 * d * d);
+                w[i] = d / m;
+            }
+        }
+        
+        //! The start of the tail
+        static constexpr double RIGHT = 3.442619855899;
+        
+        std::array<std::uint32_t, 128> k; //!< Thresholds for the fast path, per layer
+        std::array<double, 128> w; //!< Layer widths, scaled to the 32-bit integer range
+        std::array<double, 128> f; //!< The density at the layer edges
+    };
+    
+    //! Fill a range with random samples from a normal distribution
+    /*! Uses the ziggurat method on blocks of raw engine words. Almost 99% of samples take the fast
+        path of one comparison and one multiplication. The rest draw extra words from the engine.
+        @warning The engine needs to satisfy producesFullWords() */
+    template <typename ForwardIterator, typename Engine>
+    void generateGaussianRandom(ForwardIterator begin, ForwardIterator end, double mean, double deviation, Engine& engine)
+    {
+        using T = typename std::iterator_traits<ForwardIterator>::value_type;
+        
+        static const GaussianZiggurat ziggurat;
+        
+        const auto next = [&]{ std::uint32_t word; generateRandomBits(engine, &word, &word + 1); return word; };
+        const auto uniform = [&]{ return ((next() >> 8) + 0.5) / 16777216.0; };
+        
+        // The slow path: the wedges between layers and the tail beyond the base layer
+        const auto fix = [&](std::int32_t hz, std::uint32_t iz)
+        {
+            while (true)
+            {
+                double x = hz * ziggurat.w[iz];
+                if (iz == 0)
+                {
+                    double y;
+                    do
+                    {
+                        x = -std::log(uniform()) / GaussianZiggurat::RIGHT;
+                        y = -std::log(uniform());
+                    } while (y + y < x * x);
+                    
+                    return hz > 0 ? GaussianZiggurat::RIGHT + x : -GaussianZiggurat::RIGHT - x;
+                }
+                
+                if (ziggurat.f[iz] + uniform() * (ziggurat.f[iz - 1] - ziggurat.f[iz]) < std::exp(-0.5 * x * x))
+                    return x;
+                
+                hz = static_cast<std::int32_t>(next());
+                iz = hz & 127;
+                if (static_cast<std::uint32_t>(std::abs(static_cast<std::int64_t>(hz))) < ziggurat.k[iz])
+                    return hz * ziggurat.w[iz];
+            }
+        };
+        
+        std::uint32_t words[RANDOM_BLOCK_SIZE];
+        for (auto remaining = static_cast<std::size_t>(std::distance(begin, end)); remaining > 0;)
+        {
+            const auto count = std::min(remaining, RANDOM_BLOCK_SIZE);
+            remaining -= count;
+            
+            generateRandomBits(engine, words, words + count);
+            for (std::size_t i = 0; i < count; ++i, ++begin)
+            {
+                const auto hz = static_cast<std::int32_t>(words[i]);
+                const auto iz = words[i] & 127;
+                const auto x = static_cast<std::uint32_t>(std::abs(static_cast<std::int64_t>(hz))) < ziggurat.k[iz] ? hz * ziggurat.w[iz] : fix(hz, iz);
+                *begin = static_cast<T>(mean + deviation * x);
+            }
+        }
+    }
+    
+    //! Generate random uniform samples, writing them to an output iterator
+    /*! Converts the samples in fixed-size blocks on the stack, so it doesn't allocate and can be
+        used with output iterators that aren't forward iterators */
+    template <typename T, typename OutputIterator, typename Engine, typename Min, typename Max>
+    OutputIterator generateUniformRandomBuffer(OutputIterator out, std::size_t size, const Min& a, const Max& b, Engine& engine)
+    {
+        T block[RANDOM_BLOCK_SIZE];
+        while (size > 0)
+        {
+            const auto count = std::min(size, RANDOM_BLOCK_SIZE);
+            size -= count;
+            
+            generateUniformRandom(block, block + count, a, b, engine);
+            out = std::copy(block, block + count, out);
+        }
+        
+        return out;
+    }
+    
     //! Generate a random uniform buffer
     template <typename T, typename Engine, typename Min, typename Max>
     std::vector<T> generateUniformRandomBuffer(std::size_t size, const Min& a, const Max& b, Engine& engine)
     {
         std::vector<T> result(size);
-        std::generate(result.begin(), result.end(), [&]{ return generateUniformRandom<T>(a, b, engine); });
+        generateUniformRandom(result.begin(), result.end(), a, b, engine);
         
         return result;
     }
+    
+    //! The number of samples generated from each independent stream in parallel generation
+    constexpr std::size_t RANDOM_PARALLEL_CHUNK_SIZE = 16384;
+    
+    //! The number of values each split stream may consume before overlapping the next
+    constexpr std::uint64_t RANDOM_STREAM_SPACING = std::uint64_t{1} << 40;
+    
+    //! Split off the index'th independent stream of a Philox engine, in constant time
+    /*! splitStream(splitStream(engine, a), b) == splitStream(engine, a + b) */
+    inline Philox4x32 splitStream(Philox4x32 engine, std::uint64_t index)
+    {
+        engine.seek(engine.position() + index * RANDOM_STREAM_SPACING);
+        return engine;
+    }
+    
+    //! Split off the index'th independent stream of a PCG engine, in logarithmic time
+    /*! splitStream(splitStream(engine, a), b) == splitStream(engine, a + b) */
+    inline Pcg32 splitStream(Pcg32 engine, std::uint64_t index)
+    {
+        engine.discard(index * RANDOM_STREAM_SPACING);
+        return engine;
+    }
+    
+    //! Split off the index'th independent stream of a xoshiro engine, using one jump per index
+    /*! splitStream(splitStream(engine, a), b) == splitStream(engine, a + b) */
+    inline Xoshiro256StarStar splitStream(Xoshiro256StarStar engine, std::uint64_t index)
+    {
+        while (index--)
+            engine.jump();
+        
+        return engine;
+    }
+    
+    //! Fill a range with random uniform samples using multiple threads
+    /*! The range is divided into chunks of RANDOM_PARALLEL_CHUNK_SIZE samples, and every chunk is
+        generated from its own stream, split off the engine with splitStream(). The output therefore
+        only depends on the engine, never on the number of threads. Afterwards the engine is moved
+        past all streams that were used.
+        @param threadCount The number of threads to use, or 0 for the hardware concurrency */
+    template <typename RandomAccessIterator, typename Engine, typename Min, typename Max>
+    void generateUniformRandomParallel(RandomAccessIterator begin, RandomAccessIterator end, const Min& a, const Max& b, Engine& engine, std::size_t threadCount = 0)
+    {
+        const auto size = static_cast<std::size_t>(std::distance(begin, end));
+        const auto chunkCount = (size + RANDOM_PARALLEL_CHUNK_SIZE - 1) / RANDOM_PARALLEL_CHUNK_SIZE;
+        
+        if (threadCount == 0)
+            threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        
+        threadCount = std::min(threadCount, chunkCount);
+        
+        // Every thread takes a contiguous run of chunks, stepping to the next stream per chunk
+        const auto generateChunks = [&](std::size_t firstChunk, std::size_t lastChunk)
+        {
+            auto stream = splitStream(engine, firstChunk);
+            for (auto chunk = firstChunk; chunk < lastChunk; ++chunk)
+            {
+                auto chunkEngine = stream;
+                const auto chunkBegin = begin + chunk * RANDOM_PARALLEL_CHUNK_SIZE;
+                const auto chunkEnd = begin + std::min((chunk + 1) * RANDOM_PARALLEL_CHUNK_SIZE, size);
+                generateUniformRandom(chunkBegin, chunkEnd, a, b, chunkEngine);
+                
+                stream = splitStream(stream, 1);
+            }
+        };
+        
+        std::vector<std::thread> threads;
+        for (std::size_t thread = 1; thread < threadCount; ++thread)
+            threads.emplace_back(generateChunks, chunkCount * thread / threadCount, chunkCount * (thread + 1) / threadCount);
+        
+        if (threadCount > 0)
+            generateChunks(0, chunkCount / threadCount);
+        
+        for (auto& thread : threads)
+            thread.join();
+        
+        engine = splitStream(engine, chunkCount);
+    }
 }
 
 #endif
@@ -9,9 +9,15 @@
 #ifndef DSPERADOS_MATH_SIGMOID_HPP
 #define DSPERADOS_MATH_SIGMOID_HPP
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstddef>
+#include <limits>
 #include <stdexcept>
 
+#include "approximation.hpp"
+
 namespace math
 {
     //! Normalized sigmoid function
@@ -33,34 +39,411 @@ namespace math
     }
     
     //! Normalized sigmoid function using tan
-    template <typename T>
+    /*! @tparam Math The math policy, use FastMath to opt into the fast approximations */
+    template <typename T, typename Math = StandardMath>
     T sigmoidTan(const T& x, double negativeFactor, double positiveFactor)
     {
         if (negativeFactor <= 0 || positiveFactor <=0)
             throw std::runtime_error("Factor <= 0");
         
         if (x > 0)
-            return std::atan(x * positiveFactor) * (1 / std::atan(positiveFactor));
+            return Math::atan(x * positiveFactor) * (1 / Math::atan(positiveFactor));
         else if (x < 0)
-            return atan(x * negativeFactor) * (1 / atan(negativeFactor));
+            return Math::atan(x * negativeFactor) * (1 / Math::atan(negativeFactor));
         else
             return 0;
     }
     
     //! Normalized sigmoid function using exp
-    template <typename T>
+    /*! @tparam Math The math policy, use FastMath to opt into the fast approximations */
+    template <typename T, typename Math = StandardMath>
     T sigmoidExp(const T& x, double negativeFactor, double positiveFactor)
     {
         if (negativeFactor <= 0 || positiveFactor <=0)
             throw std::runtime_error("Factor <= 0");
         
         if (x > 0)
-            return (1 - std::exp(-x * positiveFactor)) / (1 - std::exp(-positiveFactor)) ;
+            return (1 - Math::exp(-x * positiveFactor)) / (1 - Math::exp(-positiveFactor)) ;
         else if (x < 0)
-            return (-1 + std::exp(x * negativeFactor)) / (1 - std::exp(-negativeFactor));
+            return (-1 + Math::exp(x * negativeFactor)) / (1 - Math::exp(-negativeFactor));
         else
             return 0;
     }
+    
+    //! The shape of the sigmoid function, x / (1 + |x|)
+    struct SigmoidShape
+    {
+        template <typename Math, typename T>
+        static T apply(const T& x) { return x / (1 + std::abs(x)); }
+        
+        //! The antiderivative, |x| - ln(1 + |x|)
+        template <typename Math, typename T>
+        static T antiderivative(const T& x)
+        {
+            const auto a = std::abs(x);
+            return a - static_cast<T>(Math::log(1 + a));
+        }
+        
+        //! The second antiderivative, sign(x) * (x^2 / 2 - (1 + |x|) * ln(1 + |x|) + |x|)
+        template <typename Math, typename T>
+        static T secondAntiderivative(const T& x)
+        {
+            const auto a = std::abs(x);
+            return std::copysign(a * a / 2 - (1 + a) * static_cast<T>(Math::log(1 + a)) + a, x);
+        }
+    };
+    
+    //! The shape of the sigmoid function using tan, atan(x)
+    struct SigmoidTanShape
+    {
+        template <typename Math, typename T>
+        static T apply(const T& x) { return static_cast<T>(Math::atan(x)); }
+        
+        //! The antiderivative, x * atan(x) - ln(1 + x^2) / 2
+        template <typename Math, typename T>
+        static T antiderivative(const T& x)
+        {
+            return x * static_cast<T>(Math::atan(x)) - static_cast<T>(Math::log(1 + x * x)) / 2;
+        }
+        
+        //! The second antiderivative, ((x^2 - 1) * atan(x) + x - x * ln(1 + x^2)) / 2
+        template <typename Math, typename T>
+        static T secondAntiderivative(const T& x)
+        {
+            return ((x * x - 1) * static_cast<T>(Math::atan(x)) + x - x * static_cast<T>(Math::log(1 + x * x))) / 2;
+        }
+    };
+    
+    //! The shape of the sigmoid function using exp, sign(x) * (1 - exp(-|x|))
+    struct SigmoidExpShape
+    {
+        template <typename Math, typename T>
+        static T apply(const T& x) { return std::copysign(1 - static_cast<T>(Math::exp(-std::abs(x))), x); }
+        
+        //! The antiderivative, |x| + exp(-|x|) - 1
+        template <typename Math, typename T>
+        static T antiderivative(const T& x)
+        {
+            const auto a = std::abs(x);
+            return a + static_cast<T>(Math::exp(-a)) - 1;
+        }
+        
+        //! The second antiderivative, sign(x) * (x^2 / 2 - |x| + 1 - exp(-|x|))
+        template <typename Math, typename T>
+        static T secondAntiderivative(const T& x)
+        {
+            const auto a = std::abs(x);
+            return std::copysign(a * a / 2 - a + 1 - static_cast<T>(Math::exp(-a)), x);
+        }
+    };
+    
+    //! Normalized, asymmetric waveshaper for whole blocks of samples
+    /*! Equivalent to sigmoid(), sigmoidTan() and sigmoidExp(), but the factors are validated and the
+        normalization gains computed once, instead of per sample. The sign of the input selects the
+        factor and gain with a blend instead of a branch, so the block loop vectorizes (given a math
+        policy that does, like FastMath). Changing the factors ramps them linearly over the next block,
+        during which the gains are recomputed per sample.
+        
+        @tparam Shape The odd shaping function, like SigmoidShape, SigmoidTanShape or SigmoidExpShape
+        @tparam Math The math policy, use FastMath to opt into the fast approximations
+        
+        @code{cpp}
+        SigmoidTanWaveshaper<float, FastMath<>> shaper(2, 4);
+        shaper.process(input.data(), output.data(), output.size());
+        
+        // Glides to the new factors over the next block
+        shaper.setFactors(3, 3);
+        shaper.process(input.data(), output.data(), output.size());
+        @endcode */
+    template <typename T, class Shape, class Math = StandardMath>
+    class Waveshaper
+    {
+    public:
+        //! Construct the waveshaper
+        /*! @throw std::runtime_error if either factor <= 0 */
+        Waveshaper(double negativeFactor, double positiveFactor)
+        {
+            setFactors(negativeFactor, positiveFactor);
+            settle();
+        }
+        
+        //! Change the factors, which are reached at the end of the next processed block
+        /*! @throw std::runtime_error if either factor <= 0 */
+        void setFactors(double negativeFactor, double positiveFactor)
+        {
+            if (negativeFactor <= 0 || positiveFactor <= 0)
+                throw std::runtime_error("Factor <= 0");
+            
+            targetNegativeFactor = static_cast<T>(negativeFactor);
+            targetPositiveFactor = static_cast<T>(positiveFactor);
+        }
+        
+        //! Shape a single sample with the current factors
+        T process(const T& x) const
+        {
+            return shape(x, negativeFactor, positiveFactor, negativeGain, positiveGain);
+        }
+        
+        //! Shape a block of samples, input and output may be the same
+        /*! If the factors have changed, they ramp linearly to their targets over the block */
+        void process(const T* in, T* out, std::size_t size)
+        {
+            if (size == 0)
+                return;
+            
+            if (negativeFactor == targetNegativeFactor && positiveFactor == targetPositiveFactor)
+            {
+                const auto kn = negativeFactor;
+                const auto kp = positiveFactor;
+                const auto gn = negativeGain;
+                const auto gp = positiveGain;
+                for (std::size_t i = 0; i < size; ++i)
+                    out[i] = shape(in[i], kn, kp, gn, gp);
+                
+                return;
+            }
+            
+            // Ramp the factors, recomputing the gains per sample so the output stays normalized
+            const auto kn = negativeFactor;
+            const auto kp = positiveFactor;
+            const auto step = T{1} / static_cast<T>(size);
+            const auto deltaNegativeFactor = (targetNegativeFactor - kn) * step;
+            const auto deltaPositiveFactor = (targetPositiveFactor - kp) * step;
+            
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                const auto t = static_cast<T>(i + 1);
+                const auto factor = in[i] > 0 ? kp + t * deltaPositiveFactor : kn + t * deltaNegativeFactor;
+                out[i] = Shape::template apply<Math>(in[i] * factor) / Shape::template apply<Math>(factor);
+            }
+            
+            settle();
+        }
+        
+        //! The factor applied to negative input, as reached after the last block
+        T getNegativeFactor() const { return negativeFactor; }
+        
+        //! The factor applied to positive input, as reached after the last block
+        T getPositiveFactor() const { return positiveFactor; }
+        
+    private:
+        //! Jump to the target factors, and compute the gains that normalize the output to 1 at x = 1 and -1 at x = -1
+        void settle()
+        {
+            negativeFactor = targetNegativeFactor;
+            positiveFactor = targetPositiveFactor;
+            negativeGain = static_cast<T>(1 / Shape::template apply<StandardMath>(static_cast<double>(negativeFactor)));
+            positiveGain = static_cast<T>(1 / Shape::template apply<StandardMath>(static_cast<double>(positiveFactor)));
+        }
+        
+        //! Shape a sample, selecting the factor and gain by the sign of the input without branching
+        static T shape(const T& x, const T& negativeFactor, const T& positiveFactor, const T& negativeGain, const T& positiveGain)
+        {
+            const auto positive = x > 0;
+            return Shape::template apply<Math>(x * (positive ? positiveFactor : negativeFactor)) * (positive ? positiveGain : negativeGain);
+        }
+        
+    private:
+        //! The factors as reached after the last block
+        T negativeFactor = 1;
+        T positiveFactor = 1;
+        
+        //! The gains belonging to the current factors
+        T negativeGain = 1;
+        T positiveGain = 1;
+        
+        //! The factors to ramp to over the next block
+        T targetNegativeFactor = 1;
+        T targetPositiveFactor = 1;
+    };
+    
+    //! Block waveshaper equivalent to sigmoid()
+    template <typename T, class Math = StandardMath>
+    using SigmoidWaveshaper = Waveshaper<T, SigmoidShape, Math>;
+    
+    //! Block waveshaper equivalent to sigmoidTan()
+    template <typename T, class Math = StandardMath>
+    using SigmoidTanWaveshaper = Waveshaper<T, SigmoidTanShape, Math>;
+    
+    //! Block waveshaper equivalent to sigmoidExp()
+    template <typename T, class Math = StandardMath>
+    using SigmoidExpWaveshaper = Waveshaper<T, SigmoidExpShape, Math>;
+    
+    //! The number of samples an antialiased waveshaper processes per pass
+    constexpr std::size_t ADAA_BLOCK_SIZE = 256;
+    
+    //! Normalized, asymmetric waveshaper with antiderivative anti-aliasing (ADAA)
+    /*! Instead of shaping each sample, the first order variant takes the difference of the
+        antiderivative between consecutive samples, divided by the difference of the samples. This is
+        the average of the shape over the line between the samples, which suppresses aliasing at
+        roughly twice the cost of plain shaping. The second order variant does the same on the second
+        antiderivative over three samples, which suppresses more. When consecutive samples come too close
+        for the division to be accurate, the shape (or antiderivative) at their midpoint is used instead.
+        
+        The antiderivatives are evaluated for a whole pass first, and the differences taken in a second
+        pass, so both vectorize (given a math policy that does, like FastMath). The ill-conditioned
+        samples are fixed up afterwards in a scalar loop, as they're rare.
+        
+        One object processes one channel, carrying the last input samples between blocks. New factors
+        take effect at the next block.
+        
+        @tparam Shape The odd shaping function, like SigmoidShape, SigmoidTanShape or SigmoidExpShape
+        @tparam Order 1 or 2, which add a delay of half a sample and a sample respectively
+        @tparam Math The math policy, use FastMath to opt into the fast approximations
+        
+        @code{cpp}
+        std::vector<AntialiasedWaveshaper<float, SigmoidTanShape, 1, FastMath<>>> shapers(channels, {4, 4});
+        for (std::size_t channel = 0; channel < channels; ++channel)
+            shapers[channel].process(input[channel], output[channel], frames);
+        @endcode */
+    template <typename T, class Shape, std::size_t Order = 1, class Math = StandardMath>
+    class AntialiasedWaveshaper
+    {
+        static_assert(Order == 1 || Order == 2, "Only first and second order are supported");
+        
+    public:
+        //! Construct the waveshaper
+        /*! @throw std::runtime_error if either factor <= 0 */
+        AntialiasedWaveshaper(double negativeFactor, double positiveFactor) :
+            tolerance(static_cast<T>(std::pow(std::numeric_limits<T>::epsilon(), Order == 1 ? 1 / 3.0 : 1 / 4.0)))
+        {
+            setFactors(negativeFactor, positiveFactor);
+        }
+        
+        //! Change the factors, from the next block on
+        /*! @throw std::runtime_error if either factor <= 0 */
+        void setFactors(double negativeFactor, double positiveFactor)
+        {
+            if (negativeFactor <= 0 || positiveFactor <= 0)
+                throw std::runtime_error("Factor <= 0");
+            
+            this->negativeFactor = static_cast<T>(negativeFactor);
+            this->positiveFactor = static_cast<T>(positiveFactor);
+            
+            // With shape(x) = gain * s(k * x), the antiderivatives scale by gain / k and gain / k^2
+            const auto negativeGain = 1 / Shape::template apply<StandardMath>(negativeFactor);
+            const auto positiveGain = 1 / Shape::template apply<StandardMath>(positiveFactor);
+            negativeGains = {{static_cast<T>(negativeGain), static_cast<T>(negativeGain / negativeFactor), static_cast<T>(negativeGain / (negativeFactor * negativeFactor))}};
+            positiveGains = {{static_cast<T>(positiveGain), static_cast<T>(positiveGain / positiveFactor), static_cast<T>(positiveGain / (positiveFactor * positiveFactor))}};
+        }
+        
+        //! Shape a block of samples, input and output may be the same
+        void process(const T* in, T* out, std::size_t size)
+        {
+            // The previous inputs, followed by the pass
+            T x[ADAA_BLOCK_SIZE + Order];
+            T antiderivatives[ADAA_BLOCK_SIZE + Order];
+            T differences[ADAA_BLOCK_SIZE + 1];
+            
+            for (std::size_t offset = 0; offset < size; offset += ADAA_BLOCK_SIZE)
+            {
+                const auto count = std::min(size - offset, ADAA_BLOCK_SIZE);
+                std::copy(history.begin(), history.end(), x);
+                std::copy(in + offset, in + offset + count, x + Order);
+                std::copy(x + count, x + count + Order, history.begin());
+                
+                for (std::size_t i = 0; i < count + Order; ++i)
+                    antiderivatives[i] = evaluate<Order>(x[i]);
+                
+                if (Order == 1)
+                {
+                    divideDifferences(x, antiderivatives, out + offset, count);
+                }
+                else
+                {
+                    divideDifferences(x, antiderivatives, differences, count + 1);
+                    divideSecondDifferences(x, differences, out + offset, count);
+                }
+            }
+        }
+        
+        //! Clear the previous inputs
+        void reset()
+        {
+            history.fill(0);
+        }
+        
+        //! The delay introduced, in samples
+        static constexpr double getLatency() { return Order / 2.0; }
+        
+    private:
+        //! Evaluate the shape (0), or its first or second antiderivative, with the factor and gain for the sign of x
+        template <std::size_t Antiderivative>
+        T evaluate(const T& x) const
+        {
+            // Load both sides unconditionally, so the selection becomes a blend
+            const T factors[2] = {negativeFactor, positiveFactor};
+            const T gains[2] = {negativeGains[Antiderivative], positiveGains[Antiderivative]};
+            const auto positive = x > 0;
+            const auto factor = positive ? factors[1] : factors[0];
+            const auto gain = positive ? gains[1] : gains[0];
+            
+            if constexpr (Antiderivative == 0)
+                return gain * Shape::template apply<Math>(x * factor);
+            else if constexpr (Antiderivative == 1)
+                return gain * Shape::template antiderivative<Math>(x * factor);
+            else
+                return gain * Shape::template secondAntiderivative<Math>(x * factor);
+        }
+        
+        //! Divide the differences of consecutive antiderivative values by those of the inputs
+        /*! Where the inputs are too close, evaluates one antiderivative lower at their midpoint instead */
+        void divideDifferences(const T* x, const T* antiderivatives, T* out, std::size_t count) const
+        {
+            const auto limit = tolerance;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const auto delta = x[i + 1] - x[i];
+                out[i] = (antiderivatives[i + 1] - antiderivatives[i]) / (std::abs(delta) < limit ? 1 : delta);
+            }
+            
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (std::abs(x[i + 1] - x[i]) < tolerance)
+                    out[i] = evaluate<Order - 1>((x[i + 1] + x[i]) / 2);
+            }
+        }
+        
+        //! Combine the first divided differences of the second antiderivative into the second order output
+        void divideSecondDifferences(const T* x, const T* differences, T* out, std::size_t count) const
+        {
+            const auto limit = tolerance;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const auto delta = x[i + 2] - x[i];
+                out[i] = 2 * (differences[i + 1] - differences[i]) / (std::abs(delta) < limit ? 1 : delta);
+            }
+            
+            // If the outer samples are close, integrate over the line from their midpoint to the middle sample
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (std::abs(x[i + 2] - x[i]) >= tolerance)
+                    continue;
+                
+                const auto midpoint = (x[i + 2] + x[i]) / 2;
+                const auto delta = midpoint - x[i + 1];
+                if (std::abs(delta) < tolerance)
+                    out[i] = evaluate<0>((midpoint + x[i + 1]) / 2);
+                else
+                    out[i] = 2 / delta * (evaluate<1>(midpoint) + (evaluate<2>(x[i + 1]) - evaluate<2>(midpoint)) / delta);
+            }
+        }
+        
+    private:
+        //! The factors for negative and positive input
+        T negativeFactor = 1;
+        T positiveFactor = 1;
+        
+        //! The scale of the shape, its antiderivative and its second antiderivative, for negative and positive input
+        std::array<T, 3> negativeGains = {};
+        std::array<T, 3> positiveGains = {};
+        
+        //! The distance between inputs below which the divided differences are ill-conditioned
+        T tolerance = 0;
+        
+        //! The last inputs of the previous block
+        std::array<T, Order> history = {};
+    };
 }
 
 #endif /* DSPERADOS_MATH_SIGMOID_HPP */
@@ -9,32 +9,226 @@
 #ifndef DSPERADOS_MATH_SINUSOID_HPP
 #define DSPERADOS_MATH_SINUSOID_HPP
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <iterator>
 #include <vector>
 
 #include "constants.hpp"
 
 namespace math
 {
+    //! Sinusoid oscillator based on a complex rotation recurrence
+    /*! Produces sine and cosine together without calling sin() or cos() per sample. The oscillator
+        keeps LANES phasors, one per consecutive sample, and rotates all of them by LANES steps at once.
+        The lanes are independent, so the rotation vectorizes. Every rotation also pulls the phasors
+        back onto the unit circle with a Newton step, which keeps amplitude drift bounded.
+        
+        @code{cpp}
+        SinusoidOscillator<float> oscillator(440.0 / 44100.0);
+        
+        oscillator.generate(sine.data(), cosine.data(), sine.size());
+        @endcode */
+    template <typename T>
+    class SinusoidOscillator
+    {
+    public:
+        //! The number of samples computed side-by-side
+        static constexpr std::size_t LANES = 8;
+        
+    public:
+        //! Construct the oscillator
+        /*! @param frequency The frequency in cycles per sample, which doesn't need to be an integer number of cycles per buffer
+            @param phase The phase of the first sample, in radians
+            @param amplitude The peak amplitude of the output */
+        SinusoidOscillator(double frequency = 0, double phase = 0, T amplitude = 1) :
+            amplitude(amplitude),
+            frequency(frequency)
+        {
+            setPhase(phase);
+        }
+        
+        //! Generate the sine and cosine side-by-side
+        void generate(T* sine, T* cosine, std::size_t size)
+        {
+            render<true, true>(sine, cosine, size);
+        }
+        
+        //! Generate the sine
+        void generateSine(T* sine, std::size_t size)
+        {
+            render<true, false>(sine, nullptr, size);
+        }
+        
+        //! Generate the cosine
+        void generateCosine(T* cosine, std::size_t size)
+        {
+            render<false, true>(nullptr, cosine, size);
+        }
+        
+        //! Change the frequency, continuing from the current phase
+        /*! Calls sin() and cos() once per lane, so don't call this per sample */
+        void setFrequency(double frequency)
+        {
+            this->frequency = frequency;
+            
+            // Derive the current phase from the phasor of the next sample
+            if (index == LANES)
+            {
+                rotate();
+                index = 0;
+            }
+            
+            setPhase(std::atan2(static_cast<double>(imag[index]), static_cast<double>(real[index])));
+        }
+        
+        //! Jump to a phase, in radians
+        void setPhase(double phase)
+        {
+            for (std::size_t k = 0; k < LANES; ++k)
+            {
+                real[k] = static_cast<T>(std::cos(phase + TAU<double> * frequency * k));
+                imag[k] = static_cast<T>(std::sin(phase + TAU<double> * frequency * k));
+            }
+            
+            stepReal = static_cast<T>(std::cos(TAU<double> * frequency * LANES));
+            stepImag = static_cast<T>(std::sin(TAU<double> * frequency * LANES));
+            index = 0;
+        }
+        
+        //! Change the peak amplitude
+        void setAmplitude(T amplitude) { this->amplitude = amplitude; }
+        
+        //! The frequency in cycles per sample
+        double getFrequency() const { return frequency; }
+        
+        //! The peak amplitude
+        T getAmplitude() const { return amplitude; }
+        
+    private:
+        //! Write the lanes, finishing the current group of samples first
+        template <bool Sine, bool Cosine>
+        void render(T* sine, T* cosine, std::size_t size)
+        {
+            std::size_t i = 0;
+            for (; i < size && index < LANES; ++i, ++index)
+                write<Sine, Cosine>(sine, cosine, i, index);
+            
+            for (; size - i >= LANES; i += LANES)
+            {
+                rotate();
+                for (std::size_t k = 0; k < LANES; ++k)
+                    write<Sine, Cosine>(sine, cosine, i + k, k);
+            }
+            
+            if (i < size)
+            {
+                rotate();
+                for (index = 0; i < size; ++i, ++index)
+                    write<Sine, Cosine>(sine, cosine, i, index);
+            }
+        }
+        
+        //! Write a single lane to the output
+        template <bool Sine, bool Cosine>
+        void write(T* sine, T* cosine, std::size_t i, std::size_t lane) const
+        {
+            if (Sine)
+                sine[i] = imag[lane] * amplitude;
+            if (Cosine)
+                cosine[i] = real[lane] * amplitude;
+        }
+        
+        //! Advance every lane by LANES samples, and renormalize
+        void rotate()
+        {
+            for (std::size_t k = 0; k < LANES; ++k)
+            {
+                const auto re = real[k] * stepReal - imag[k] * stepImag;
+                const auto im = real[k] * stepImag + imag[k] * stepReal;
+                
+                // A first order approximation of 1 / |z| around 1
+                const auto gain = T{1.5} - T{0.5} * (re * re + im * im);
+                real[k] = re * gain;
+                imag[k] = im * gain;
+            }
+        }
+        
+    private:
+        //! The real (cosine) and imaginary (sine) parts of the phasor per lane
+        T real[LANES];
+        T imag[LANES];
+        
+        //! The rotation of LANES samples
+        T stepReal = 1;
+        T stepImag = 0;
+        
+        //! The peak amplitude
+        T amplitude = 1;
+        
+        //! The frequency in cycles per sample
+        double frequency = 0;
+        
+        //! The lane of the next sample to output, or LANES if the lanes need rotating first
+        std::size_t index = 0;
+    };
+    
+    //! The number of samples generated at once by the buffer generators
+    constexpr std::size_t SINUSOID_BLOCK_SIZE = 256;
+    
+    //! Generate a sine wave, writing it to an output iterator
+    /*! Doesn't allocate, so it can be used on real-time threads with a preallocated output */
+    template <typename OutputIterator, typename = typename std::iterator_traits<OutputIterator>::iterator_category>
+    OutputIterator generateSineBuffer(OutputIterator out, std::size_t size, float order = 1, float amplitude = 1)
+    {
+        SinusoidOscillator<double> oscillator(order / static_cast<double>(size), 0, amplitude);
+        
+        double block[SINUSOID_BLOCK_SIZE];
+        for (std::size_t i = 0; i < size; i += SINUSOID_BLOCK_SIZE)
+        {
+            const auto count = std::min(size - i, SINUSOID_BLOCK_SIZE);
+            oscillator.generateSine(block, count);
+            out = std::copy(block, block + count, out);
+        }
+        
+        return out;
+    }
+    
     //! Generate a sine wave in a buffer
     template <typename T>
     std::vector<T> generateSineBuffer(std::size_t size, float order = 1, float amplitude = 1)
     {
         std::vector<T> buffer(size);
-        for (auto i = 0; i < size; ++i)
-            buffer[i] = sin(i / static_cast<double>(size) * TAU<double> * order) * amplitude;
+        generateSineBuffer(buffer.begin(), size, order, amplitude);
         
         return buffer;
     }
     
+    //! Generate a cosine wave, writing it to an output iterator
+    /*! Doesn't allocate, so it can be used on real-time threads with a preallocated output */
+    template <typename OutputIterator, typename = typename std::iterator_traits<OutputIterator>::iterator_category>
+    OutputIterator generateCosineBuffer(OutputIterator out, std::size_t size, float order = 1, float amplitude = 1)
+    {
+        SinusoidOscillator<double> oscillator(order / static_cast<double>(size), 0, amplitude);
+        
+        double block[SINUSOID_BLOCK_SIZE];
+        for (std::size_t i = 0; i < size; i += SINUSOID_BLOCK_SIZE)
+        {
+            const auto count = std::min(size - i, SINUSOID_BLOCK_SIZE);
+            oscillator.generateCosine(block, count);
+            out = std::copy(block, block + count, out);
+        }
+        
+        return out;
+    }
+    
     //! Generate a cosine wave in a buffer
     template <typename T>
     std::vector<T> generateCosineBuffer(std::size_t size, float order = 1, float amplitude = 1)
     {
         std::vector<T> buffer(size);
-        for (auto i = 0; i < size; ++i)
-            buffer[i] = cos((i / static_cast<double>(size)) * TAU<double> * order) * amplitude;
+        generateCosineBuffer(buffer.begin(), size, order, amplitude);
         
         return buffer;
     }
@@ -0,0 +1,247 @@
+//
+//  smooth.hpp
+//  Math
+//
+//  Copyright © 2015-2016 Dsperados (info@dsperados.com). All rights reserved.
+//  Licensed under the BSD 3-clause license.
+//
+
+#ifndef DSPERADOS_MATH_SMOOTH_HPP
+#define DSPERADOS_MATH_SMOOTH_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "approximation.hpp"
+#include "ease.hpp"
+
+namespace math
+{
+    //! The distance to the target left at the end of a one-pole ramp, relative to where it started (-60 dB)
+    constexpr double ONE_POLE_RESIDUE = 1e-3;
+    
+    //! A bank of parameters that glide to their targets, rendered a block at a time
+    /*! Every parameter ramps towards its target over a number of samples, along any easing curve or
+        along a one-pole (exponential) curve. The state is stored as a structure of arrays, and each
+        ramp is computed in closed form from the number of samples done, so a block renders without a
+        recurrence and vectorizes. Parameters that have reached their target are skipped entirely.
+        
+        @tparam Math The math policy for the one-pole and transcendental easing curves, use FastMath to have those vectorize
+        
+        @code{cpp}
+        SmoothedParameterBank<float> bank(1000, 512);
+        bank.setTarget(0, 0.5f, 480, EaseCurve::IN_OUT_CUBIC);
+        bank.setTargetOnePole(1, 1.f, 2400);
+        
+        bank.process(512);
+        const float* gain = bank.getValues(0);
+        @endcode */
+    template <typename T, class Math = StandardMath>
+    class SmoothedParameterBank
+    {
+    public:
+        //! Construct the bank, with all parameters settled at an initial value
+        /*! @param maxBlockSize The largest number of samples rendered in one go
+            @throw std::invalid_argument if maxBlockSize == 0 */
+        SmoothedParameterBank(std::size_t parameterCount, std::size_t maxBlockSize, const T& initial = 0) :
+            maxBlockSize(maxBlockSize)
+        {
+            if (maxBlockSize == 0)
+                throw std::invalid_argument("maxBlockSize == 0");
+            
+            values.assign(parameterCount, initial);
+            starts.assign(parameterCount, initial);
+            targets.assign(parameterCount, initial);
+            done.assign(parameterCount, 0);
+            lengths.assign(parameterCount, 0);
+            logCoefficients.assign(parameterCount, 0);
+            curves.assign(parameterCount, EaseCurve::LINEAR);
+            onePole.assign(parameterCount, false);
+            smoothing.assign(parameterCount, false);
+            rows.assign(parameterCount * maxBlockSize, initial);
+        }
+        
+        //! Ramp a parameter from its current value to a target along an easing curve
+        /*! A length of 0 jumps to the target immediately */
+        void setTarget(std::size_t parameter, const T& target, std::size_t length, EaseCurve curve = EaseCurve::LINEAR)
+        {
+            start(parameter, target, length);
+            curves[parameter] = curve;
+            onePole[parameter] = false;
+        }
+        
+        //! Ramp a parameter from its current value to a target along a one-pole curve
+        /*! The value decays exponentially towards the target, covering all but ONE_POLE_RESIDUE of the
+            distance in the given length, after which it snaps to the target. A length of 0 jumps to the
+            target immediately. */
+        void setTargetOnePole(std::size_t parameter, const T& target, std::size_t length)
+        {
+            start(parameter, target, length);
+            logCoefficients[parameter] = length > 0 ? static_cast<T>(std::log(ONE_POLE_RESIDUE) / length) : T{0};
+            onePole[parameter] = true;
+        }
+        
+        //! Jump to a value immediately, cancelling any ramp
+        void setValue(std::size_t parameter, const T& value)
+        {
+            start(parameter, value, 0);
+        }
+        
+        //! Render the next block of values for all parameters
+        /*! @throw std::invalid_argument if size > maxBlockSize */
+        void process(std::size_t size)
+        {
+            if (size > maxBlockSize)
+                throw std::invalid_argument("size > maxBlockSize");
+            
+            if (size == 0)
+                return;
+            
+            for (std::size_t a = 0; a < active.size();)
+            {
+                const auto parameter = active[a];
+                T* row = &rows[parameter * maxBlockSize];
+                
+                // Render the part of the block that's still ramping, and hold the target after that
+                const auto count = std::min(size, lengths[parameter] - done[parameter]);
+                if (onePole[parameter])
+                    renderOnePole(parameter, row, count);
+                else
+                    renderEase(parameter, row, count);
+                
+                done[parameter] += count;
+                if (done[parameter] < lengths[parameter])
+                {
+                    values[parameter] = row[count - 1];
+                    ++a;
+                }
+                else
+                {
+                    // Settled, fill the rest of the row once so it can be skipped from now on
+                    settle(parameter, count);
+                    active[a] = active.back();
+                    active.pop_back();
+                }
+            }
+        }
+        
+        //! The values of a parameter for the last rendered block
+        const T* getValues(std::size_t parameter) const { return &rows[parameter * maxBlockSize]; }
+        
+        //! The value of a parameter at the end of the last rendered block
+        T getValue(std::size_t parameter) const { return values[parameter]; }
+        
+        //! The target of a parameter
+        T getTarget(std::size_t parameter) const { return targets[parameter]; }
+        
+        //! Is a parameter still ramping towards its target?
+        bool isSmoothing(std::size_t parameter) const { return smoothing[parameter]; }
+        
+        //! The number of parameters still ramping towards their target
+        std::size_t getSmoothingCount() const { return active.size(); }
+        
+        //! The number of parameters
+        std::size_t getParameterCount() const { return values.size(); }
+        
+        //! The largest number of samples rendered in one go
+        std::size_t getMaxBlockSize() const { return maxBlockSize; }
+        
+    private:
+        //! Start a ramp from the current value
+        void start(std::size_t parameter, const T& target, std::size_t length)
+        {
+            starts[parameter] = values[parameter];
+            targets[parameter] = target;
+            done[parameter] = 0;
+            lengths[parameter] = length;
+            
+            if (length == 0)
+            {
+                if (smoothing[parameter])
+                    active.erase(std::find(active.begin(), active.end(), parameter));
+                
+                settle(parameter, 0);
+            }
+            else if (!smoothing[parameter])
+            {
+                smoothing[parameter] = true;
+                active.emplace_back(parameter);
+            }
+        }
+        
+        //! Land on the target, filling the row from a given sample on
+        void settle(std::size_t parameter, std::size_t from)
+        {
+            values[parameter] = targets[parameter];
+            smoothing[parameter] = false;
+            
+            auto row = rows.begin() + parameter * maxBlockSize;
+            std::fill(row + from, row + maxBlockSize, targets[parameter]);
+        }
+        
+        //! Render a ramp along an easing curve, as start + distance * curve((done + i + 1) / length)
+        void renderEase(std::size_t parameter, T* row, std::size_t count) const
+        {
+            const auto length = static_cast<T>(lengths[parameter]);
+            const auto begin = static_cast<T>(done[parameter] + 1) / length;
+            const auto end = static_cast<T>(done[parameter] + 1 + count) / length;
+            ease<T, Math>(curves[parameter], begin, end, row, count);
+            
+            const auto from = starts[parameter];
+            const auto distance = targets[parameter] - from;
+            for (std::size_t i = 0; i < count; ++i)
+                row[i] = from + distance * row[i];
+        }
+        
+        //! Render a one-pole ramp, as target - distance * coefficient^(done + i + 1)
+        void renderOnePole(std::size_t parameter, T* row, std::size_t count) const
+        {
+            const auto to = targets[parameter];
+            const auto distance = to - starts[parameter];
+            const auto logCoefficient = logCoefficients[parameter];
+            const auto first = static_cast<T>(done[parameter] + 1);
+            for (std::size_t i = 0; i < count; ++i)
+                row[i] = to - distance * static_cast<T>(Math::exp((first + static_cast<T>(i)) * logCoefficient));
+        }
+        
+    private:
+        //! The largest number of samples rendered in one go
+        std::size_t maxBlockSize = 0;
+        
+        //! The value per parameter at the end of the last block
+        std::vector<T> values;
+        
+        //! The value per parameter at the start of its ramp
+        std::vector<T> starts;
+        
+        //! The target per parameter
+        std::vector<T> targets;
+        
+        //! The number of samples of the ramp done, and the length of the ramp, per parameter
+        std::vector<std::size_t> done;
+        std::vector<std::size_t> lengths;
+        
+        //! The logarithm of the one-pole coefficient per parameter
+        std::vector<T> logCoefficients;
+        
+        //! The easing curve per parameter
+        std::vector<EaseCurve> curves;
+        
+        //! Does the parameter ramp along a one-pole curve, rather than an easing curve?
+        std::vector<bool> onePole;
+        
+        //! Is the parameter still ramping?
+        std::vector<bool> smoothing;
+        
+        //! The parameters that are still ramping
+        std::vector<std::size_t> active;
+        
+        //! The rendered values, one row of maxBlockSize per parameter
+        std::vector<T> rows;
+    };
+}
+
+#endif
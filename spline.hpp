@@ -9,8 +9,10 @@
 #ifndef DSPERADOS_MATH_SPLINE_HPP
 #define DSPERADOS_MATH_SPLINE_HPP
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <iterator>
 #include <vector>
 
 #include "analysis.hpp"
@@ -48,7 +50,7 @@ namespace math
         void emplace(const std::vector<U>& x, const std::vector<float>& y)
         {
             auto n = std::min(x.size(), y.size());
-            for (auto i = 0; i < n; ++i)
+            for (std::size_t i = 0; i < n; ++i)
                 emplacePoint(x[i], y[i]);
             
             recomputeCoefficients();
@@ -61,7 +63,7 @@ namespace math
         void emplaceByIndex(const std::vector<U>& indices, const std::vector<float>& values)
         {
             auto n = std::min(indices.size(), values.size());
-            for (auto i = 0; i < n; ++i)
+            for (std::size_t i = 0; i < n; ++i)
                 emplacePoint(indices[i], values[indices[i]]);
             
             recomputeCoefficients();
@@ -94,13 +96,51 @@ namespace math
             return it->a + (it->b * f) + (it->c * f2) + (it->d * f * f2);
         }
         
-        // Access a range of points on the spline
-        std::vector<float> span(std::ptrdiff_t offset, size_t length)
+        //! Emplace points by index, reusing the existing storage
+        /*! @param values Random access iterator to the y-values, per 1 x
+            @param indicesBegin, indicesEnd Indexes into the values */
+        template <class RandomAccessIterator, class IndexIterator>
+        void emplaceByIndex(RandomAccessIterator values, IndexIterator indicesBegin, IndexIterator indicesEnd)
         {
-            std::vector<float> out(length);
+            for (; indicesBegin != indicesEnd; ++indicesBegin)
+                emplacePoint(*indicesBegin, values[*indicesBegin]);
             
-            for (auto i = 0; i < length; ++i)
-                out[i] = (*this)[offset + i];
+            recomputeCoefficients();
+        }
+        
+        //! Remove all points, but keep the allocated storage
+        void clear()
+        {
+            points.clear();
+        }
+        
+        //! Allocate storage for a number of points up front
+        /*! After this, adding up to that many points won't allocate */
+        void reserve(std::size_t size)
+        {
+            points.reserve(size);
+            alpha.reserve(size);
+            dx.reserve(size);
+            l.reserve(size);
+            mu.reserve(size);
+            z.reserve(size);
+        }
+        
+        //! Access a range of points on the spline, writing them to an output iterator
+        template <class OutputIterator>
+        OutputIterator span(std::ptrdiff_t offset, std::size_t length, OutputIterator out) const
+        {
+            for (std::size_t i = 0; i < length; ++i)
+                *out++ = (*this)[offset + static_cast<std::ptrdiff_t>(i)];
+            
+            return out;
+        }
+        
+        //! Access a range of points on the spline
+        std::vector<float> span(std::ptrdiff_t offset, size_t length) const
+        {
+            std::vector<float> out(length);
+            span(offset, length, out.begin());
             
             return out;
         }
@@ -152,11 +192,11 @@ namespace math
             auto n = points.size() - 1;
             
             dx.resize(n);
-            for (auto i = 0; i < n; ++i)
+            for (std::size_t i = 0; i < n; ++i)
                 dx[i] = points[i + 1].x - points[i].x;
             
             alpha.resize(n);
-            for (auto i = 1; i < n; ++i)
+            for (std::size_t i = 1; i < n; ++i)
                 alpha[i] = 3.0 * (points[i + 1].a - points[i].a) / dx[i] - 3.0 * (points[i].a - points[i - 1].a) / dx[i - 1];
             
             l.resize(n + 1);
@@ -166,7 +206,7 @@ namespace math
             l[0] = l[n] = 1;
             mu[0] = z[0] = z[n] = 0;
             
-            for (auto i = 1; i < n; ++i)
+            for (std::size_t i = 1; i < n; ++i)
             {
                 l[i] = 2.0 * (points[i + 1].x - points[i - 1].x) - dx[i - 1] * mu[i - 1];
                 mu[i] = dx[i] / l[i];
@@ -195,28 +235,58 @@ namespace math
         std::vector<float> z;
     };
     
+    //! Generate the minima spline of a range, writing it to an output iterator
+    /*! The spline and positions are caller-supplied scratch space, which is cleared but keeps its
+        capacity, so no allocation happens in steady state */
+    template <typename RandomAccessIterator, typename OutputIterator>
+    OutputIterator minimaSpline(RandomAccessIterator begin, RandomAccessIterator end, OutputIterator out, CubicSpline& spline, std::vector<size_t>& positions)
+    {
+        positions.clear();
+        findLocalMinimaPositions(begin, end, std::back_inserter(positions));
+        
+        spline.clear();
+        spline.emplaceByIndex(begin, positions.begin(), positions.end());
+        
+        return spline.span(0, std::distance(begin, end), out);
+    }
+    
     //! Generate the minima spline of a vector
     template <typename T>
     inline static std::vector<T> minimaSpline(const std::vector<T>& x)
     {
-        auto min = findLocalMinimaPositions(x.begin(), x.end());
-        
+        std::vector<T> result(x.size());
         CubicSpline spline;
-        spline.emplaceByIndex(min, x);
+        std::vector<size_t> positions;
+        minimaSpline(x.begin(), x.end(), result.begin(), spline, positions);
         
-        return spline.span(0, x.size());
+        return result;
     }
     
-    //! Generate the maxima spline of a vector
-    template <typename T, long N>
-    inline static std::vector<T> maximaSpline(std::vector<T> x)
+    //! Generate the maxima spline of a range, writing it to an output iterator
+    /*! The spline and positions are caller-supplied scratch space, which is cleared but keeps its
+        capacity, so no allocation happens in steady state */
+    template <typename RandomAccessIterator, typename OutputIterator>
+    OutputIterator maximaSpline(RandomAccessIterator begin, RandomAccessIterator end, OutputIterator out, CubicSpline& spline, std::vector<size_t>& positions)
     {
-        auto max = findLocalMaximaPositions(x.begin(), x.end());
+        positions.clear();
+        findLocalMaximaPositions(begin, end, std::back_inserter(positions));
+        
+        spline.clear();
+        spline.emplaceByIndex(begin, positions.begin(), positions.end());
         
+        return spline.span(0, std::distance(begin, end), out);
+    }
+    
+    //! Generate the maxima spline of a vector
+    template <typename T>
+    inline static std::vector<T> maximaSpline(const std::vector<T>& x)
+    {
+        std::vector<T> result(x.size());
         CubicSpline spline;
-        spline.emplaceByIndex(max, x);
+        std::vector<size_t> positions;
+        maximaSpline(x.begin(), x.end(), result.begin(), spline, positions);
         
-        return spline.span(0, x.size());
+        return result;
     }
 }
 
@@ -0,0 +1,120 @@
+//
+//  stride.hpp
+//  Math
+//
+//  Copyright © 2015-2016 Dsperados (info@dsperados.com). All rights reserved.
+//  Licensed under the BSD 3-clause license.
+//
+
+#ifndef DSPERADOS_MATH_STRIDE_HPP
+#define DSPERADOS_MATH_STRIDE_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+
+namespace math
+{
+    //! Random access iterator that skips a fixed number of elements per step
+    /*! Keeps the first element and a step index rather than advancing the underlying iterator, so
+        the end of a strided range never points beyond the end of the underlying range */
+    template <class Iterator>
+    class StridedIterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::iterator_traits<Iterator>::pointer;
+        using reference = typename std::iterator_traits<Iterator>::reference;
+        
+    public:
+        StridedIterator() = default;
+        StridedIterator(Iterator first, std::ptrdiff_t stride, std::ptrdiff_t index = 0) : first(first), step(stride), position(index) { }
+        
+        reference operator*() const { return first[position * step]; }
+        pointer operator->() const { return &first[position * step]; }
+        reference operator[](difference_type n) const { return first[(position + n) * step]; }
+        
+        StridedIterator& operator++() { ++position; return *this; }
+        StridedIterator operator++(int) { auto copy = *this; ++position; return copy; }
+        StridedIterator& operator--() { --position; return *this; }
+        StridedIterator operator--(int) { auto copy = *this; --position; return copy; }
+        
+        StridedIterator& operator+=(difference_type n) { position += n; return *this; }
+        StridedIterator& operator-=(difference_type n) { position -= n; return *this; }
+        StridedIterator operator+(difference_type n) const { return {first, step, position + n}; }
+        StridedIterator operator-(difference_type n) const { return {first, step, position - n}; }
+        friend StridedIterator operator+(difference_type n, const StridedIterator& it) { return it + n; }
+        
+        difference_type operator-(const StridedIterator& rhs) const { return position - rhs.position; }
+        
+        bool operator==(const StridedIterator& rhs) const { return position == rhs.position; }
+        bool operator!=(const StridedIterator& rhs) const { return position != rhs.position; }
+        bool operator<(const StridedIterator& rhs) const { return position < rhs.position; }
+        bool operator>(const StridedIterator& rhs) const { return position > rhs.position; }
+        bool operator<=(const StridedIterator& rhs) const { return position <= rhs.position; }
+        bool operator>=(const StridedIterator& rhs) const { return position >= rhs.position; }
+        
+        //! The underlying iterator to the element this iterator points to
+        /*! @warning Only valid for iterators that point into the range, not for the end iterator */
+        Iterator base() const { return first + position * step; }
+        
+        //! The number of underlying elements per step
+        std::ptrdiff_t stride() const { return step; }
+        
+    private:
+        //! The first element of the strided range
+        Iterator first = Iterator();
+        
+        //! The number of underlying elements per step
+        std::ptrdiff_t step = 1;
+        
+        //! The number of steps taken from the first element
+        std::ptrdiff_t position = 0;
+    };
+    
+    //! Non-owning view of a single channel in an interleaved range
+    /*! Allows running any iterator-based algorithm on one channel without deinterleaving first.
+        
+        @code{cpp}
+        ChannelView<const float*> left(data, data + frames * 2, 2, 0);
+        auto rms = rootMeanSquare<float>(left.begin(), left.end());
+        @endcode */
+    template <class Iterator>
+    class ChannelView
+    {
+    public:
+        using iterator = StridedIterator<Iterator>;
+        
+    public:
+        //! Construct a view of a channel in an interleaved range
+        /*! @throw std::invalid_argument if channel >= channelCount */
+        ChannelView(Iterator begin, Iterator end, std::size_t channelCount, std::size_t channel)
+        {
+            if (channel >= channelCount)
+                throw std::invalid_argument("channel >= channelCount");
+            
+            frames = std::distance(begin, end) / static_cast<std::ptrdiff_t>(channelCount);
+            first = iterator(frames > 0 ? begin + channel : begin, channelCount);
+        }
+        
+        iterator begin() const { return first; }
+        iterator end() const { return first + frames; }
+        
+        //! Access a frame of the channel
+        typename iterator::reference operator[](std::size_t frame) const { return first[frame]; }
+        
+        //! The number of frames in the channel
+        std::size_t size() const { return frames; }
+        
+    private:
+        //! The first sample of the channel
+        iterator first;
+        
+        //! The number of frames
+        std::ptrdiff_t frames = 0;
+    };
+}
+
+#endif
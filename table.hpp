@@ -0,0 +1,223 @@
+//
+//  table.hpp
+//  Math
+//
+//  Copyright © 2015-2016 Dsperados (info@dsperados.com). All rights reserved.
+//  Licensed under the BSD 3-clause license.
+//
+
+#ifndef DSPERADOS_MATH_TABLE_HPP
+#define DSPERADOS_MATH_TABLE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "access.hpp"
+#include "approximation.hpp"
+#include "interpolation.hpp"
+
+namespace math
+{
+    //! The number of points a function table evaluates per pass
+    constexpr std::size_t TABLE_BLOCK_SIZE = 256;
+    
+    //! The spacing of the points in a function table
+    enum class TableSpacing
+    {
+        UNIFORM,
+        LOGARITHMIC
+    };
+    
+    //! A smooth function sampled over a fixed domain, evaluated by interpolating between the samples
+    /*! Trades accuracy for speed on functions that are expensive to compute per sample, like
+        sigmoidExp(), easeCircular() or skew(). The samples are padded with linearly extrapolated
+        guard samples, so the interpolator reads them without any bounds checking. Input outside of
+        the domain is clamped to it. The largest interpolation error, measured at build time between
+        every pair of samples, is available through getMaxError().
+        
+        @tparam Interpolator The interpolation function object, like LinearInterpolation or CatmullRomInterpolation
+        @tparam Math The math policy for the logarithm of a logarithmic table
+        
+        @code{cpp}
+        // Refine until the error drops below 1e-6
+        auto table = FunctionTable<float>::refine([](double x){ return sigmoidExp(x, 4, 4); }, -2, 2, 1e-6);
+        
+        table(input.data(), output.data(), input.size());
+        @endcode */
+    template <typename T, class Interpolator = CatmullRomInterpolation, class Math = StandardMath>
+    class FunctionTable
+    {
+    public:
+        //! The number of guard samples before and after the table
+        static constexpr std::size_t GUARD_BEFORE = Interpolator::size / 2 - 1;
+        static constexpr std::size_t GUARD_AFTER = Interpolator::size / 2;
+        
+    public:
+        //! Sample a function at a number of points, including both ends of the domain
+        /*! @throw std::invalid_argument if size < 2, max <= min, or min <= 0 for logarithmic spacing */
+        template <class Function>
+        FunctionTable(Function function, double min, double max, std::size_t size, TableSpacing spacing = TableSpacing::UNIFORM, Interpolator interpolator = Interpolator()) :
+            spacing(spacing),
+            interpolator(interpolator)
+        {
+            if (size < 2)
+                throw std::invalid_argument("size < 2");
+            
+            if (max <= min)
+                throw std::invalid_argument("max <= min");
+            
+            if (spacing == TableSpacing::LOGARITHMIC && min <= 0)
+                throw std::invalid_argument("min <= 0 for a logarithmic table");
+            
+            this->min = static_cast<T>(min);
+            this->max = static_cast<T>(max);
+            
+            // Index = (x or log(x) - start) / step
+            start = spacing == TableSpacing::LOGARITHMIC ? std::log(min) : min;
+            step = ((spacing == TableSpacing::LOGARITHMIC ? std::log(max) : max) - start) / (size - 1);
+            inverseStep = static_cast<T>(1 / step);
+            
+            samples.resize(GUARD_BEFORE + size + GUARD_AFTER);
+            const auto first = samples.begin() + GUARD_BEFORE;
+            for (std::size_t i = 0; i < size; ++i)
+                first[i] = static_cast<T>(function(position(i)));
+            
+            for (std::size_t i = 1; i <= GUARD_BEFORE; ++i)
+                first[-static_cast<std::ptrdiff_t>(i)] = first[0] - static_cast<T>(i) * (first[1] - first[0]);
+            
+            for (std::size_t i = 1; i <= GUARD_AFTER; ++i)
+                first[size - 1 + i] = first[size - 1] + static_cast<T>(i) * (first[size - 1] - first[size - 2]);
+            
+            // Measure the error in between every pair of samples
+            for (std::size_t i = 0; i + 1 < size; ++i)
+            {
+                for (auto fraction : {0.25, 0.5, 0.75})
+                {
+                    const auto x = position(i + fraction);
+                    maxError = std::max(maxError, std::abs(static_cast<double>((*this)(static_cast<T>(x))) - static_cast<double>(function(x))));
+                }
+            }
+        }
+        
+        //! Sample a function, doubling the number of samples until the interpolation error drops below a tolerance
+        /*! Starts out with 16 samples, and stops at maxSize even if the tolerance isn't met
+            @throw std::invalid_argument if tolerance <= 0, max <= min, or min <= 0 for logarithmic spacing */
+        template <class Function>
+        static FunctionTable refine(Function function, double min, double max, double tolerance, TableSpacing spacing = TableSpacing::UNIFORM, std::size_t maxSize = 65536, Interpolator interpolator = Interpolator())
+        {
+            if (tolerance <= 0)
+                throw std::invalid_argument("tolerance <= 0");
+            
+            FunctionTable table(function, min, max, std::min<std::size_t>(16, std::max<std::size_t>(maxSize, 2)), spacing, interpolator);
+            for (auto size = table.size() * 2 - 1; table.getMaxError() > tolerance && size <= maxSize; size = size * 2 - 1)
+                table = FunctionTable(function, min, max, size, spacing, interpolator);
+            
+            return table;
+        }
+        
+        //! Evaluate the table at a point
+        T operator()(const T& x) const
+        {
+            T y;
+            if (spacing == TableSpacing::LOGARITHMIC)
+                evaluate<true>(&x, &y, 1);
+            else
+                evaluate<false>(&x, &y, 1);
+            
+            return y;
+        }
+        
+        //! Evaluate the table for a block of points, input and output may be the same
+        void operator()(const T* in, T* out, std::size_t size) const
+        {
+            if (spacing == TableSpacing::LOGARITHMIC)
+                evaluate<true>(in, out, size);
+            else
+                evaluate<false>(in, out, size);
+        }
+        
+        //! The largest absolute interpolation error found while building the table
+        double getMaxError() const { return maxError; }
+        
+        //! The number of samples, without the guard samples
+        std::size_t size() const { return samples.size() - GUARD_BEFORE - GUARD_AFTER; }
+        
+        //! The start of the domain
+        T getMin() const { return min; }
+        
+        //! The end of the domain
+        T getMax() const { return max; }
+        
+    private:
+        //! The point in the domain belonging to a (fractional) index
+        double position(double index) const
+        {
+            const auto x = start + index * step;
+            return spacing == TableSpacing::LOGARITHMIC ? std::exp(x) : x;
+        }
+        
+        //! Evaluate a block of points
+        /*! Computes and clamps the indices for a chunk of points first, so that the clamping, logarithm
+            and scaling vectorize, and the interpolation loop that follows is free of branches */
+        template <bool Logarithmic>
+        void evaluate(const T* in, T* out, std::size_t size) const
+        {
+            auto interpolate = interpolator;
+            const auto begin = samples.begin() + GUARD_BEFORE;
+            const auto end = samples.end() - GUARD_AFTER;
+            const auto first = static_cast<T>(start);
+            const auto last = static_cast<T>(this->size() - 1);
+            const auto low = min;
+            const auto high = max;
+            const auto scale = inverseStep;
+            
+            T indices[TABLE_BLOCK_SIZE];
+            for (std::size_t offset = 0; offset < size; offset += TABLE_BLOCK_SIZE)
+            {
+                const auto count = std::min(size - offset, TABLE_BLOCK_SIZE);
+                
+                // The (fractional) index belonging to each point, clamped to the table
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    const T value = in[offset + i];
+                    const T x = value < low ? low : high < value ? high : value;
+                    const T linear = Logarithmic ? static_cast<T>(Math::log(x)) : x;
+                    const T index = (linear - first) * scale;
+                    indices[i] = index < 0 ? 0 : last < index ? last : index;
+                }
+                
+                for (std::size_t i = 0; i < count; ++i)
+                    out[offset + i] = static_cast<T>(interpolate(begin, end, indices[i], UncheckedAccess()));
+            }
+        }
+        
+    private:
+        //! The sampled function, surrounded by guard samples
+        std::vector<T> samples;
+        
+        //! The spacing of the samples
+        TableSpacing spacing = TableSpacing::UNIFORM;
+        
+        //! The interpolation function object
+        Interpolator interpolator;
+        
+        //! The domain
+        T min = 0;
+        T max = 0;
+        
+        //! The first point, and distance between points, on the (logarithmic) axis of the table
+        double start = 0;
+        double step = 0;
+        
+        //! The reciprocal of the step
+        T inverseStep = 0;
+        
+        //! The largest absolute interpolation error found while building
+        double maxError = 0;
+    };
+}
+
+#endif
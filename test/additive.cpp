@@ -0,0 +1,100 @@
+#include <cmath>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../additive.hpp"
+#include "../constants.hpp"
+
+using namespace math;
+using namespace std;
+
+TEST_CASE("AdditiveSynthesizer")
+{
+    const vector<double> frequencies = {0.01, 0.023, 0.1};
+    const vector<double> amplitudes = {0.5, 0.25, 0.125};
+    const vector<double> phases = {0, 1, 2};
+    
+    AdditiveSynthesizer<double> synthesizer(3);
+    CHECK(synthesizer.getPartialCount() == 3);
+    
+    vector<double> out(1000);
+    synthesizer.process(out.data(), out.size());
+    for (auto& x : out)
+        CHECK(x == 0);
+    
+    SUBCASE("constant partials")
+    {
+        synthesizer.setPartials(frequencies.data(), amplitudes.data(), phases.data());
+        for (size_t i = 0; i < out.size(); i += 100)
+            synthesizer.process(&out[i], 100);
+        
+        for (size_t i = 0; i < out.size(); ++i)
+        {
+            double expected = 0;
+            for (auto p = 0; p < 3; ++p)
+                expected += amplitudes[p] * sin(TAU<double> * frequencies[p] * i + phases[p]);
+            
+            CHECK(out[i] == doctest::Approx(expected).epsilon(1e-9));
+        }
+    }
+    
+    SUBCASE("ramps")
+    {
+        synthesizer.setPartials(frequencies.data(), amplitudes.data(), phases.data());
+        
+        const vector<double> targetFrequencies = {0.02, 0.013, 0.1};
+        const vector<double> targetAmplitudes = {0.25, 0.25, 0};
+        synthesizer.process(out.data(), out.size(), targetFrequencies.data(), targetAmplitudes.data());
+        
+        // Integrate the linearly changing frequency for the phase
+        const auto n = static_cast<double>(out.size());
+        for (size_t i = 0; i < out.size(); ++i)
+        {
+            double expected = 0;
+            for (auto p = 0; p < 3; ++p)
+            {
+                const auto slope = (targetFrequencies[p] - frequencies[p]) / n;
+                const auto phase = TAU<double> * (frequencies[p] * i + slope * i * (i - 1.0) / 2) + phases[p];
+                const auto amplitude = amplitudes[p] + (targetAmplitudes[p] - amplitudes[p]) * i / n;
+                expected += amplitude * sin(phase);
+            }
+            
+            CHECK(out[i] == doctest::Approx(expected).epsilon(1e-9));
+        }
+        
+        // Hold the targets afterwards
+        vector<double> next(10);
+        synthesizer.process(next.data(), next.size());
+        for (size_t i = 0; i < next.size(); ++i)
+        {
+            const auto phase0 = TAU<double> * ((frequencies[0] + targetFrequencies[0]) / 2 * n - (targetFrequencies[0] - frequencies[0]) / 2) + phases[0];
+            const auto phase1 = TAU<double> * ((frequencies[1] + targetFrequencies[1]) / 2 * n - (targetFrequencies[1] - frequencies[1]) / 2) + phases[1];
+            const auto expected = 0.25 * sin(phase0 + TAU<double> * 0.02 * i) + 0.25 * sin(phase1 + TAU<double> * 0.013 * i);
+            CHECK(next[i] == doctest::Approx(expected).epsilon(1e-9));
+        }
+    }
+    
+    SUBCASE("many partials in float")
+    {
+        const size_t count = 1001;
+        vector<double> f(count), p(count, 0);
+        vector<float> a(count, 1.0f / count);
+        for (size_t k = 0; k < count; ++k)
+            f[k] = 0.0004 * (k + 1);
+        
+        AdditiveSynthesizer<float> many(count);
+        many.setPartials(f.data(), a.data(), p.data());
+        vector<float> y(64);
+        many.process(y.data(), y.size());
+        
+        for (size_t i = 0; i < y.size(); i += 7)
+        {
+            double expected = 0;
+            for (size_t k = 0; k < count; ++k)
+                expected += sin(TAU<double> * f[k] * i) / count;
+            
+            CHECK(y[i] == doctest::Approx(expected).epsilon(1e-4));
+        }
+    }
+}
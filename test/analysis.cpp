@@ -0,0 +1,117 @@
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <list>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../analysis.hpp"
+#include "../sinusoid.hpp"
+#include "../spline.hpp"
+
+using namespace math;
+using namespace std;
+
+TEST_CASE("analysis")
+{
+    const vector<float> x = {3, 1, 2, 0, 4, 2, 5, 5};
+    
+    SUBCASE("findLocalMinimaPositions()")
+    {
+        CHECK((findLocalMinimaPositions(x.begin(), x.end()) == vector<size_t>{1, 3, 5}));
+        
+        array<size_t, 8> positions;
+        auto end = findLocalMinimaPositions(x.begin(), x.end(), positions.begin());
+        CHECK(distance(positions.begin(), end) == 3);
+        CHECK(positions[2] == 5);
+        
+        CHECK(findLocalMinimaPositions(x.begin(), x.begin() + 2).empty());
+    }
+    
+    SUBCASE("findLocalMaximaPositions()")
+    {
+        CHECK((findLocalMaximaPositions(x.begin(), x.end()) == vector<size_t>{2, 4, 6}));
+        
+        array<size_t, 8> positions;
+        auto end = findLocalMaximaPositions(x.begin(), x.end(), positions.begin());
+        CHECK(distance(positions.begin(), end) == 3);
+    }
+    
+    SUBCASE("minimaSpline() and maximaSpline()")
+    {
+        CubicSpline spline;
+        spline.reserve(x.size());
+        vector<size_t> positions;
+        positions.reserve(x.size());
+        
+        vector<float> out(x.size());
+        minimaSpline(x.begin(), x.end(), out.begin(), spline, positions);
+        CHECK(out == minimaSpline(x));
+        CHECK(out[1] == doctest::Approx(1));
+        CHECK(out[3] == doctest::Approx(0));
+        CHECK(out[5] == doctest::Approx(2));
+        
+        // Reuse the same scratch space
+        maximaSpline(x.begin(), x.end(), out.begin(), spline, positions);
+        CHECK(out == maximaSpline(x));
+        CHECK(out[2] == doctest::Approx(2));
+        CHECK(out[4] == doctest::Approx(4));
+        CHECK(out[6] == doctest::Approx(5));
+    }
+    
+    SUBCASE("generateSineBuffer() and generateCosineBuffer()")
+    {
+        array<double, 16> sine, cosine;
+        generateSineBuffer(sine.begin(), sine.size(), 2, 0.5);
+        generateCosineBuffer(cosine.begin(), cosine.size(), 2, 0.5);
+        
+        const auto expectedSine = generateSineBuffer<double>(16, 2, 0.5);
+        const auto expectedCosine = generateCosineBuffer<double>(16, 2, 0.5);
+        for (auto i = 0; i < 16; ++i)
+        {
+            CHECK(sine[i] == expectedSine[i]);
+            CHECK(cosine[i] == expectedCosine[i]);
+            CHECK(sine[i] * sine[i] + cosine[i] * cosine[i] == doctest::Approx(0.25));
+        }
+    }
+    
+    SUBCASE("findPeak() and findExtrema()")
+    {
+        // Longer than the lanes, with the peak in a column other than the first
+        vector<float> x(300);
+        for (size_t i = 0; i < x.size(); ++i)
+            x[i] = (i % 7) * 0.1f - 0.3f;
+        
+        x[130] = -2;
+        x[200] = 2;
+        x[290] = -2;
+        
+        auto peak = findPeak(x.data(), x.size());
+        CHECK(peak.value == -2);
+        CHECK(peak.index == 130);
+        CHECK(findExtrema(x.begin(), x.end()) == x.begin() + 130);
+        
+        // The generic version agrees
+        list<float> l(x.begin(), x.end());
+        CHECK(distance(l.begin(), findExtrema(l.begin(), l.end())) == 130);
+        
+        // The first peak wins, also when it's in the remainder after the columns
+        x.assign(70, 1);
+        CHECK(findPeak(x.data(), x.size()).index == 0);
+        x[66] = -3;
+        x[68] = 3;
+        CHECK(findPeak(x.data(), x.size()).index == 66);
+        
+        // NaN counts as the largest
+        x[40] = NAN;
+        x[50] = NAN;
+        peak = findPeak(x.data(), x.size());
+        CHECK(peak.index == 40);
+        CHECK(std::isnan(peak.value));
+        CHECK(findExtrema(x.cbegin(), x.cend()) == x.cbegin() + 40);
+        
+        CHECK(findPeak(x.data(), 0).value == 0);
+        CHECK(findExtrema(x.begin(), x.begin()) == x.begin());
+    }
+}
@@ -0,0 +1,121 @@
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../approximation.hpp"
+#include "../interpolation.hpp"
+#include "../sigmoid.hpp"
+
+using namespace math;
+using namespace std;
+
+template <typename T, typename Approximation, typename Reference>
+static double maxRelativeError(Approximation approximation, Reference reference, double min, double max)
+{
+    double error = 0;
+    for (auto i = 0; i <= 10000; ++i)
+    {
+        const T x = min + (max - min) * i / 10000.0;
+        const auto expected = reference(static_cast<long double>(x));
+        if (expected != 0)
+            error = std::max<double>(error, abs((approximation(x) - expected) / expected));
+    }
+    
+    return error;
+}
+
+TEST_CASE("approximation")
+{
+    SUBCASE("accuracy tiers")
+    {
+        const auto sinl = [](long double x){ return std::sin(x); };
+        const auto expl = [](long double x){ return std::exp(x); };
+        const auto logl = [](long double x){ return std::log(x); };
+        const auto atanl = [](long double x){ return std::atan(x); };
+        
+        CHECK(maxRelativeError<float>([](float x){ return fastSin<Accuracy::LOW>(x); }, sinl, -100, 100) < 1e-4);
+        CHECK(maxRelativeError<float>([](float x){ return fastSin(x); }, sinl, -100, 100) < 1e-6);
+        CHECK(maxRelativeError<double>([](double x){ return fastSin<Accuracy::HIGH>(x); }, sinl, -100, 100) < 1e-14);
+        
+        CHECK(maxRelativeError<float>([](float x){ return fastExp<Accuracy::LOW>(x); }, expl, -80, 80) < 1e-4);
+        CHECK(maxRelativeError<float>([](float x){ return fastExp(x); }, expl, -80, 80) < 1e-6);
+        CHECK(maxRelativeError<double>([](double x){ return fastExp<Accuracy::HIGH>(x); }, expl, -700, 700) < 1e-14);
+        
+        CHECK(maxRelativeError<float>([](float x){ return fastLog<Accuracy::LOW>(x); }, logl, 0.01, 100) < 1e-3);
+        CHECK(maxRelativeError<float>([](float x){ return fastLog(x); }, logl, 0.01, 100) < 1e-6);
+        CHECK(maxRelativeError<double>([](double x){ return fastLog<Accuracy::HIGH>(x); }, logl, 1e-300, 1e300) < 1e-14);
+        
+        CHECK(maxRelativeError<float>([](float x){ return fastAtan<Accuracy::LOW>(x); }, atanl, -10, 10) < 1e-4);
+        CHECK(maxRelativeError<float>([](float x){ return fastAtan(x); }, atanl, -10, 10) < 1e-6);
+        CHECK(maxRelativeError<double>([](double x){ return fastAtan<Accuracy::HIGH>(x); }, atanl, -10, 10) < 1e-14);
+        
+        for (auto x = -3.0; x <= 3.0; x += 0.01)
+        {
+            CHECK(fastCos<Accuracy::HIGH>(x) == doctest::Approx(cos(x)).epsilon(1e-14));
+            if (abs(cos(x)) > 1e-3)
+                CHECK(fastTan<Accuracy::HIGH>(x) == doctest::Approx(tan(x)).epsilon(1e-12));
+        }
+        
+        for (auto y : {-2.0, -0.5, 0.0, 0.5, 2.0})
+            for (auto x : {-2.0, -0.5, 0.5, 2.0})
+                CHECK(fastAtan2<Accuracy::HIGH>(y, x) == doctest::Approx(atan2(y, x)).epsilon(1e-14));
+    }
+    
+    SUBCASE("special values")
+    {
+        const auto infinity = numeric_limits<float>::infinity();
+        
+        CHECK(fastExp(100.0f) == infinity);
+        CHECK(fastExp(-100.0f) == 0);
+        CHECK(fastExp(88.7f) == doctest::Approx(exp(88.7f)));
+        CHECK(isnan(fastExp(numeric_limits<float>::quiet_NaN())));
+        
+        CHECK(fastLog(0.0f) == -infinity);
+        CHECK(fastLog(infinity) == infinity);
+        CHECK(isnan(fastLog(-1.0f)));
+        CHECK(fastLog(1e-40f) == doctest::Approx(log(1e-40f)));
+        
+        // Arguments beyond the supported range still give a quadrant that fits the integer
+        for (auto x : {1e10f, -3e9f, 1e30f, infinity, numeric_limits<float>::quiet_NaN()})
+        {
+            float r;
+            const auto quadrant = reduceQuarterPi(x, r);
+            CHECK(quadrant >= -4);
+            CHECK(quadrant <= 4);
+        }
+        
+        // The quadrant is taken modulo 4 beyond the range of a 32-bit count
+        CHECK(fastSin<Accuracy::HIGH>(5e9 * HALF_PI<double> + 0.5) == doctest::Approx(sin(0.5)).epsilon(1e-5));
+        
+        CHECK(fastAtan(infinity) == doctest::Approx(HALF_PI<float>));
+        CHECK(fastAtan2(0.0f, 0.0f) == 0);
+        CHECK(fastAtan2(0.0f, -1.0f) == doctest::Approx(PI<float>));
+    }
+    
+    SUBCASE("batch")
+    {
+        vector<float> x(100), y(100);
+        for (auto i = 0; i < 100; ++i)
+            x[i] = i * 0.37f - 10;
+        
+        fastSin(x.data(), y.data(), x.size());
+        for (auto i = 0; i < 100; ++i)
+            CHECK(y[i] == fastSin(x[i]));
+        
+        fastAtan2(x.data(), x.data() + 50, y.data(), 50);
+        for (auto i = 0; i < 50; ++i)
+            CHECK(y[i] == fastAtan2(x[i], x[i + 50]));
+    }
+    
+    SUBCASE("math policy")
+    {
+        CHECK((sigmoidTan<double, FastMath<>>(0.5, 2, 2) == doctest::Approx(sigmoidTan(0.5, 2, 2))));
+        CHECK((sigmoidExp<double, FastMath<>>(-0.5, 2, 2) == doctest::Approx(sigmoidExp(-0.5, 2, 2))));
+        CHECK((interpolateCosine<float, float, FastMath<>>(0.3f, 1.f, 2.f) == doctest::Approx(interpolateCosine(0.3f, 1.f, 2.f))));
+        CHECK(lin2log(0.5, 0, 1, 20, 20000, FastMath<>()) == doctest::Approx(lin2log(0.5, 0, 1, 20, 20000)));
+        CHECK(log2lin(632.0, 20, 20000, 0, 1, FastMath<>()) == doctest::Approx(log2lin(632.0, 20, 20000, 0, 1)));
+        CHECK(skew(0.5, 0, 1, 0, 0.2, 1, FastMath<>()) == doctest::Approx(skew(0.5, 0, 1, 0, 0.2, 1)));
+    }
+}
@@ -0,0 +1,101 @@
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../convolution.hpp"
+
+using namespace math;
+using namespace std;
+
+static vector<double> directConvolution(const vector<double>& x, const vector<double>& h)
+{
+    vector<double> y(x.size() + h.size() - 1, 0);
+    for (size_t i = 0; i < x.size(); ++i)
+        for (size_t j = 0; j < h.size(); ++j)
+            y[i + j] += x[i] * h[j];
+    
+    return y;
+}
+
+static vector<double> ramp(size_t size, double factor)
+{
+    vector<double> x(size);
+    for (size_t i = 0; i < size; ++i)
+        x[i] = sin(i * factor) + 0.25 * cos(i * factor * 3.1);
+    
+    return x;
+}
+
+TEST_CASE("Convolution")
+{
+    SUBCASE("FirFilter")
+    {
+        const auto x = ramp(1000, 0.05);
+        
+        for (auto kernelSize : {5, 64, 65, 300})
+        {
+            const auto h = ramp(kernelSize, 0.3);
+            const auto expected = directConvolution(x, h);
+            
+            FirFilter<double> filter(h.begin(), h.end());
+            CHECK(filter.usesFft() == (kernelSize > 64));
+            
+            vector<double> y(x.size());
+            filter.process(x.data(), y.data(), 123);
+            filter.process(x.data() + 123, y.data() + 123, x.size() - 123);
+            
+            for (size_t i = 0; i < y.size(); ++i)
+                CHECK(y[i] == doctest::Approx(expected[i]));
+        }
+        
+        // A crossover that isn't a power of two, with a kernel between it and the partition size
+        for (auto kernelSize : {60, 64, 65, 200})
+        {
+            const auto h = ramp(kernelSize, 0.3);
+            const auto expected = directConvolution(x, h);
+            
+            FirFilter<double> filter(h.begin(), h.end(), 50);
+            CHECK(filter.usesFft() == (kernelSize > 64));
+            
+            vector<double> y(x.size());
+            filter.process(x.data(), y.data(), y.size());
+            
+            for (size_t i = 0; i < y.size(); ++i)
+                CHECK(y[i] == doctest::Approx(expected[i]));
+        }
+        
+        vector<double> empty;
+        CHECK_THROWS_AS(FirFilter<double>(empty.begin(), empty.end()), std::invalid_argument);
+    }
+    
+    SUBCASE("convolve()")
+    {
+        const auto x = ramp(200, 0.1);
+        const auto h = ramp(100, 0.2);
+        const auto expected = directConvolution(x, h);
+        
+        vector<double> direct(expected.size());
+        vector<double> fast(expected.size());
+        convolve(x.begin(), x.end(), h.begin(), h.end(), direct.begin(), 1000);
+        convolve(x.begin(), x.end(), h.begin(), h.end(), fast.begin(), 8);
+        
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            CHECK(direct[i] == doctest::Approx(expected[i]));
+            CHECK(fast[i] == doctest::Approx(expected[i]));
+        }
+    }
+    
+    SUBCASE("autoCorrelate()")
+    {
+        vector<double> x{1, 2, 3};
+        vector<double> y(3);
+        autoCorrelate(x.begin(), x.end(), y.begin());
+        
+        CHECK(y[0] == doctest::Approx(14));
+        CHECK(y[1] == doctest::Approx(8));
+        CHECK(y[2] == doctest::Approx(3));
+    }
+}
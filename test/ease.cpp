@@ -0,0 +1,123 @@
+#include <cmath>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../ease.hpp"
+
+using namespace math;
+using namespace std;
+
+//! Evaluate a curve at a single index through the block version
+static double evaluate(EaseCurve curve, double index)
+{
+    double y;
+    ease(curve, index, index + 1, &y, 1);
+    return y;
+}
+
+static const EaseCurve CURVES[] =
+{
+    EaseCurve::LINEAR,
+    EaseCurve::COSINE,
+    EaseCurve::IN_QUAD, EaseCurve::OUT_QUAD, EaseCurve::IN_OUT_QUAD,
+    EaseCurve::IN_CUBIC, EaseCurve::OUT_CUBIC, EaseCurve::IN_OUT_CUBIC,
+    EaseCurve::IN_QUART, EaseCurve::OUT_QUART, EaseCurve::IN_OUT_QUART,
+    EaseCurve::IN_QUINT, EaseCurve::OUT_QUINT, EaseCurve::IN_OUT_QUINT,
+    EaseCurve::IN_EXPONENTIAL, EaseCurve::OUT_EXPONENTIAL, EaseCurve::IN_OUT_EXPONENTIAL,
+    EaseCurve::IN_CIRCULAR, EaseCurve::OUT_CIRCULAR, EaseCurve::IN_OUT_CIRCULAR,
+    EaseCurve::IN_BACK, EaseCurve::OUT_BACK, EaseCurve::IN_OUT_BACK,
+    EaseCurve::IN_ELASTIC, EaseCurve::OUT_ELASTIC, EaseCurve::IN_OUT_ELASTIC,
+    EaseCurve::IN_BOUNCE, EaseCurve::OUT_BOUNCE, EaseCurve::IN_OUT_BOUNCE
+};
+
+TEST_CASE("Ease")
+{
+    SUBCASE("end points")
+    {
+        for (auto curve : CURVES)
+        {
+            CHECK(evaluate(curve, 0) == doctest::Approx(0));
+            CHECK(evaluate(curve, 1) == doctest::Approx(1));
+        }
+    }
+    
+    SUBCASE("continuous")
+    {
+        // No jumps anywhere, including the center of the in-out curves and the bounces, the circular
+        // curves being the steepest with an infinite slope at the ends
+        for (auto curve : CURVES)
+        {
+            vector<double> y(10001);
+            ease(curve, 0.0, 1.0 + 1.0 / (y.size() - 1), y.data(), y.size());
+            
+            for (size_t i = 1; i < y.size(); ++i)
+                CHECK(abs(y[i] - y[i - 1]) < 0.02);
+        }
+    }
+    
+    SUBCASE("out mirrors in")
+    {
+        for (auto t = 0.0; t <= 1; t += 0.0625)
+        {
+            CHECK(easeOutQuad(t) == doctest::Approx(1 - easeInQuad(1 - t)));
+            CHECK(easeOutQuint(t) == doctest::Approx(1 - easeInQuint(1 - t)));
+            CHECK(easeOutCircular(t) == doctest::Approx(1 - easeCircular(1 - t)));
+            CHECK(easeInBounce(t) == doctest::Approx(1 - easeOutBounce(1 - t)));
+            CHECK(easeInOutCubic(t) == doctest::Approx(1 - easeInOutCubic(1 - t)));
+        }
+    }
+    
+    SUBCASE("known values")
+    {
+        CHECK(easeInCubic(0.5) == doctest::Approx(0.125));
+        CHECK(easeInOutQuart(0.25) == doctest::Approx(0.03125));
+        CHECK(easeInExponential(0.5) == doctest::Approx(1 / 32.0));
+        CHECK(easeCosine(0.5) == doctest::Approx(0.5));
+        CHECK(easeOutBounce(1 / 2.75) == doctest::Approx(1));
+        
+        // The back curves overshoot
+        CHECK(easeInBack(0.2) < 0);
+        CHECK(easeOutBack(0.8) > 1);
+        
+        static_assert(easeInOutQuad(0.25) == 0.125, "");
+    }
+    
+    SUBCASE("block")
+    {
+        // Two consecutive blocks equal one large block, and every point equals the scalar function
+        vector<float> whole(64);
+        vector<float> halves(64);
+        ease(EaseCurve::IN_OUT_BACK, 0.f, 1.f, whole.data(), 64);
+        ease(EaseCurve::IN_OUT_BACK, 0.f, 0.5f, halves.data(), 32);
+        ease(EaseCurve::IN_OUT_BACK, 0.5f, 1.f, halves.data() + 32, 32);
+        
+        for (size_t i = 0; i < whole.size(); ++i)
+        {
+            CHECK(whole[i] == doctest::Approx(halves[i]));
+            CHECK(whole[i] == doctest::Approx(easeInOutBack(i / 64.f)));
+        }
+        
+        // An explicit value type
+        ease<float>(EaseCurve::COSINE, 0.f, 1.f, whole.data(), 64);
+        CHECK(whole[16] == doctest::Approx(easeCosine(0.25f)));
+        
+        // Any easing function
+        ease([](float t){ return easeInOutPower<6>(t); }, 0.f, 1.f, whole.data(), 64);
+        CHECK(whole[16] == doctest::Approx(easeInOutPower<6>(0.25f)));
+    }
+    
+    SUBCASE("fast math")
+    {
+        vector<float> accurate(256);
+        vector<float> fast(256);
+        for (auto curve : {EaseCurve::COSINE, EaseCurve::IN_OUT_EXPONENTIAL, EaseCurve::OUT_ELASTIC, EaseCurve::IN_OUT_ELASTIC})
+        {
+            ease(curve, 0.f, 1.f, accurate.data(), accurate.size());
+            ease<float, FastMath<>>(curve, 0.f, 1.f, fast.data(), fast.size());
+            
+            for (size_t i = 0; i < accurate.size(); ++i)
+                CHECK(fast[i] == doctest::Approx(accurate[i]).epsilon(1e-3));
+        }
+    }
+}
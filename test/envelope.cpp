@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../envelope.hpp"
+
+using namespace math;
+using namespace std;
+
+TEST_CASE("BreakpointEnvelope")
+{
+    using Envelope = BreakpointEnvelope<double>;
+    
+    SUBCASE("linear")
+    {
+        Envelope envelope(1);
+        envelope.addLinear(3, 4);
+        envelope.addLinear(0, 2);
+        
+        Envelope::Voice voice;
+        envelope.reset(voice);
+        CHECK(envelope.isFinished(voice));
+        
+        envelope.trigger(voice);
+        CHECK(envelope.isRunning(voice));
+        
+        // Blocks of odd sizes, crossing the segment boundaries
+        vector<double> output(8);
+        envelope.process(voice, output.data(), 3);
+        envelope.process(voice, output.data() + 3, 5);
+        
+        const vector<double> expected = {1.5, 2, 2.5, 3, 1.5, 0, 0, 0};
+        for (size_t i = 0; i < output.size(); ++i)
+            CHECK(output[i] == doctest::Approx(expected[i]));
+        
+        CHECK(envelope.isFinished(voice));
+    }
+    
+    SUBCASE("exponential")
+    {
+        Envelope envelope(1);
+        envelope.addExponential(0, 100, 5);
+        envelope.addExponential(1, 100, -5);
+        envelope.addExponential(0, 100, 0);
+        
+        Envelope::Voice voice;
+        envelope.reset(voice);
+        envelope.trigger(voice);
+        vector<double> output(300);
+        envelope.process(voice, output.data(), output.size());
+        
+        // A positive curvature drops fast first, a negative one rises slowly first, near zero is linear
+        CHECK(output[49] < 0.25);
+        CHECK(output[99] == doctest::Approx(0));
+        CHECK(output[149] < 0.25);
+        CHECK(output[199] == doctest::Approx(1));
+        CHECK(output[249] == doctest::Approx(0.5));
+        CHECK(output[299] == doctest::Approx(0));
+        
+        // Each sample covers the same fraction of the distance to the anchor
+        const auto ratio = (output[11] - output[10]) / (output[10] - output[9]);
+        CHECK(ratio == doctest::Approx(exp(-5 / 100.0)));
+    }
+    
+    SUBCASE("ease and cubic")
+    {
+        Envelope envelope;
+        envelope.addEase(1, 64, EaseCurve::IN_OUT_CUBIC);
+        envelope.addCubic(0.5, 32);
+        envelope.addCubic(0, 32);
+        
+        Envelope::Voice voice;
+        envelope.reset(voice);
+        envelope.trigger(voice);
+        vector<double> output(128);
+        envelope.process(voice, output.data(), output.size());
+        
+        for (size_t i = 0; i < 64; ++i)
+            CHECK(output[i] == doctest::Approx(easeInOutCubic((i + 1) / 64.0)));
+        
+        // The cubic segments join smoothly, with a slope taken from the neighbouring breakpoints
+        CHECK(output[95] == doctest::Approx(0.5));
+        CHECK(output[96] - output[95] == doctest::Approx(output[95] - output[94]).epsilon(0.01));
+        CHECK(output[96] - output[95] == doctest::Approx(-1 / 64.0).epsilon(0.01));
+        CHECK(output[127] == doctest::Approx(0));
+    }
+    
+    SUBCASE("long cubic in float")
+    {
+        // Long segments don't drift past the breakpoint, and there's no step when landing on it
+        BreakpointEnvelope<float> envelope;
+        envelope.addCubic(1, 48000);
+        envelope.addCubic(0, 96000);
+        
+        BreakpointEnvelope<float>::Voice voice;
+        envelope.reset(voice);
+        envelope.trigger(voice);
+        vector<float> output(48000 + 96000);
+        for (size_t i = 0; i < output.size(); i += 512)
+            envelope.process(voice, output.data() + i, min<size_t>(512, output.size() - i));
+        
+        CHECK(*max_element(output.begin(), output.end()) <= 1);
+        CHECK(output[47998] == doctest::Approx(1).epsilon(1e-6));
+        CHECK(output[47999] == 1);
+        CHECK(abs(output[48000] - output[47999]) < 1e-6);
+        CHECK(abs(output[143998]) < 1e-6);
+        CHECK(output[143999] == 0);
+    }
+    
+    SUBCASE("long exponential in float")
+    {
+        // Long segments don't overshoot or stall before the breakpoint, so there's no step when landing on it
+        for (auto curvature : {-8.0, -4.0, 8.0})
+        {
+            BreakpointEnvelope<float> envelope;
+            envelope.addExponential(1, 480000, curvature);
+            
+            BreakpointEnvelope<float>::Voice voice;
+            envelope.reset(voice);
+            envelope.trigger(voice);
+            vector<float> output(480000);
+            for (size_t i = 0; i < output.size(); i += 512)
+                envelope.process(voice, output.data() + i, min<size_t>(512, output.size() - i));
+            
+            CHECK(*max_element(output.begin(), output.end()) <= 1 + 1e-6);
+            CHECK(abs(output[479998] - output[479999]) < 1e-4);
+            CHECK(output[479999] == doctest::Approx(1).epsilon(1e-6));
+        }
+    }
+    
+    SUBCASE("sustain")
+    {
+        // ADSR, sustaining at 0.5
+        Envelope envelope;
+        envelope.addLinear(1, 10);
+        envelope.addLinear(0.5, 10);
+        envelope.addLinear(0, 10);
+        envelope.setSustainLoop(2, 2);
+        
+        Envelope::Voice voice;
+        envelope.reset(voice);
+        envelope.trigger(voice);
+        vector<double> output(100);
+        envelope.process(voice, output.data(), output.size());
+        
+        CHECK(output[9] == doctest::Approx(1));
+        CHECK(output[99] == doctest::Approx(0.5));
+        CHECK(envelope.isSustaining(voice));
+        CHECK(!envelope.isFinished(voice));
+        
+        envelope.release(voice);
+        envelope.process(voice, output.data(), 20);
+        CHECK(output[4] == doctest::Approx(0.25));
+        CHECK(output[19] == doctest::Approx(0));
+        CHECK(envelope.isFinished(voice));
+    }
+    
+    SUBCASE("sustain loop")
+    {
+        Envelope envelope;
+        envelope.addLinear(1, 4);
+        envelope.addLinear(0.5, 2);
+        envelope.addLinear(1, 2);
+        envelope.addLinear(0, 4);
+        envelope.setSustainLoop(1, 3);
+        
+        Envelope::Voice voice;
+        envelope.reset(voice);
+        envelope.trigger(voice);
+        vector<double> output(12);
+        envelope.process(voice, output.data(), output.size());
+        
+        const vector<double> expected = {0.25, 0.5, 0.75, 1, 0.75, 0.5, 0.75, 1, 0.75, 0.5, 0.75, 1};
+        for (size_t i = 0; i < output.size(); ++i)
+            CHECK(output[i] == doctest::Approx(expected[i]));
+        
+        // Release in the middle of the loop, moving on from the current value
+        envelope.process(voice, output.data(), 1);
+        envelope.release(voice);
+        envelope.process(voice, output.data(), 4);
+        CHECK(output[0] == doctest::Approx(0.5625));
+        CHECK(output[3] == doctest::Approx(0));
+    }
+    
+    SUBCASE("retrigger")
+    {
+        Envelope envelope;
+        envelope.addLinear(1, 10);
+        envelope.addLinear(0, 10);
+        
+        Envelope::Voice voice;
+        envelope.reset(voice);
+        envelope.trigger(voice);
+        vector<double> output(15);
+        envelope.process(voice, output.data(), output.size());
+        CHECK(voice.value == doctest::Approx(0.5));
+        
+        // Starts over from the current value
+        envelope.trigger(voice);
+        envelope.process(voice, output.data(), 10);
+        CHECK(output[0] == doctest::Approx(0.55));
+        CHECK(output[9] == doctest::Approx(1));
+    }
+    
+    SUBCASE("throws")
+    {
+        Envelope envelope;
+        CHECK_THROWS_AS(envelope.addLinear(1, 0), std::invalid_argument);
+        
+        envelope.addLinear(1, 10);
+        CHECK_THROWS_AS(envelope.setSustainLoop(1, 0), std::invalid_argument);
+        CHECK_THROWS_AS(envelope.setSustainLoop(0, 2), std::invalid_argument);
+    }
+}
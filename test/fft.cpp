@@ -0,0 +1,113 @@
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../fft.hpp"
+
+using namespace math;
+using namespace std;
+
+static vector<complex<double>> dft(const vector<complex<double>>& x)
+{
+    vector<complex<double>> y(x.size());
+    for (size_t k = 0; k < x.size(); ++k)
+        for (size_t n = 0; n < x.size(); ++n)
+            y[k] += x[n] * polar(1.0, -TWO_PI<double> * ((k * n) % x.size()) / x.size());
+    
+    return y;
+}
+
+TEST_CASE("Fft")
+{
+    SUBCASE("Fft")
+    {
+        for (size_t size : {1, 2, 4, 8, 16, 12, 30, 7, 49, 64 * 3})
+        {
+            vector<complex<double>> x(size);
+            for (size_t i = 0; i < x.size(); ++i)
+                x[i] = {sin(i * 0.3), cos(i * 0.7)};
+            
+            const auto expected = dft(x);
+            const auto& fft = getFft<double>(size);
+            
+            SUBCASE("interleaved")
+            {
+                auto y = x;
+                fft.forward(y.data());
+                for (size_t k = 0; k < size; ++k)
+                {
+                    CHECK(y[k].real() == doctest::Approx(expected[k].real()));
+                    CHECK(y[k].imag() == doctest::Approx(expected[k].imag()));
+                }
+                
+                fft.inverse(y.data());
+                for (size_t i = 0; i < size; ++i)
+                {
+                    CHECK(y[i].real() == doctest::Approx(x[i].real()));
+                    CHECK(y[i].imag() == doctest::Approx(x[i].imag()));
+                }
+            }
+            
+            SUBCASE("split")
+            {
+                vector<double> real(size), imag(size), outReal(size), outImag(size);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    real[i] = x[i].real();
+                    imag[i] = x[i].imag();
+                }
+                
+                fft.forward(real.data(), imag.data(), outReal.data(), outImag.data());
+                for (size_t k = 0; k < size; ++k)
+                {
+                    CHECK(outReal[k] == doctest::Approx(expected[k].real()));
+                    CHECK(outImag[k] == doctest::Approx(expected[k].imag()));
+                }
+                
+                fft.inverse(outReal.data(), outImag.data());
+                for (size_t i = 0; i < size; ++i)
+                {
+                    CHECK(outReal[i] == doctest::Approx(real[i]));
+                    CHECK(outImag[i] == doctest::Approx(imag[i]));
+                }
+            }
+        }
+        
+        CHECK(&getFft<float>(32) == &getFft<float>(32));
+        CHECK_THROWS_AS(Fft<double>(0), std::invalid_argument);
+    }
+    
+    SUBCASE("RealFft")
+    {
+        for (size_t size : {2, 4, 6, 16, 18, 128})
+        {
+            vector<double> x(size);
+            vector<complex<double>> z(size);
+            for (size_t i = 0; i < size; ++i)
+                z[i] = x[i] = sin(i * 0.4) + 0.5 * cos(i * 1.3);
+            
+            const auto expected = dft(z);
+            const auto& fft = getRealFft<double>(size);
+            REQUIRE(fft.binCount() == size / 2 + 1);
+            
+            vector<complex<double>> y(fft.binCount());
+            fft.forward(x.data(), y.data());
+            for (size_t k = 0; k < y.size(); ++k)
+            {
+                CHECK(y[k].real() == doctest::Approx(expected[k].real()));
+                CHECK(y[k].imag() == doctest::Approx(expected[k].imag()));
+            }
+            
+            vector<double> out(size);
+            fft.inverse(y.data(), out.data());
+            for (size_t i = 0; i < size; ++i)
+                CHECK(out[i] == doctest::Approx(x[i]));
+        }
+        
+        CHECK_THROWS_AS(RealFft<double>(0), std::invalid_argument);
+        CHECK_THROWS_AS(RealFft<double>(5), std::invalid_argument);
+    }
+}
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../interleave.hpp"
+#include "../interpolation.hpp"
+#include "../linear.hpp"
+#include "../normalize.hpp"
+#include "../statistics.hpp"
+#include "../stride.hpp"
+
+using namespace math;
+using namespace std;
+
+TEST_CASE("Interleave")
+{
+    SUBCASE("interleave() and deinterleave() for N channels")
+    {
+        for (size_t channelCount : {1, 2, 3, 4, 8, 13, 32})
+        {
+            const size_t frames = 203;
+            
+            vector<vector<float>> channels(channelCount, vector<float>(frames));
+            vector<const float*> in(channelCount);
+            for (size_t channel = 0; channel < channelCount; ++channel)
+            {
+                for (size_t frame = 0; frame < frames; ++frame)
+                    channels[channel][frame] = channel * 1000.f + frame;
+                
+                in[channel] = channels[channel].data();
+            }
+            
+            vector<float> interleaved(channelCount * frames);
+            interleave(in.data(), channelCount, frames, interleaved.data());
+            
+            for (size_t frame = 0; frame < frames; ++frame)
+                for (size_t channel = 0; channel < channelCount; ++channel)
+                    CHECK(interleaved[frame * channelCount + channel] == channels[channel][frame]);
+            
+            vector<vector<float>> result(channelCount, vector<float>(frames));
+            vector<float*> out(channelCount);
+            for (size_t channel = 0; channel < channelCount; ++channel)
+                out[channel] = result[channel].data();
+            
+            deinterleave(interleaved.data(), channelCount, frames, out.data());
+            CHECK(result == channels);
+        }
+    }
+    
+    SUBCASE("deinterleaveConvert() and interleaveConvert()")
+    {
+        const size_t frames = 100;
+        vector<float> left(frames), right(frames);
+        for (size_t frame = 0; frame < frames; ++frame)
+        {
+            left[frame] = frame / 50.f - 1;
+            right[frame] = 1 - frame / 50.f;
+        }
+        
+        const float* in[] = {left.data(), right.data()};
+        vector<float> resultLeft(frames), resultRight(frames);
+        float* out[] = {resultLeft.data(), resultRight.data()};
+        
+        SUBCASE("int16")
+        {
+            vector<int16_t> data(frames * 2);
+            interleaveConvert<Int16Format>(in, 2, frames, data.data());
+            CHECK(data[0] == -32768);
+            CHECK(data[1] == 32767);
+            CHECK(data[100] == 0);
+            
+            deinterleaveConvert<Int16Format>(data.data(), 2, frames, out);
+            for (size_t frame = 0; frame < frames; ++frame)
+                CHECK(resultLeft[frame] == doctest::Approx(left[frame]).epsilon(0.0001));
+        }
+        
+        SUBCASE("int24")
+        {
+            vector<uint8_t> data(frames * 2 * 3);
+            interleaveConvert<Int24Format>(in, 2, frames, data.data());
+            CHECK(Int24Format::read(data.data(), 0) == -8388608);
+            CHECK(Int24Format::read(data.data(), 1) == 8388607);
+            
+            deinterleaveConvert<Int24Format>(data.data(), 2, frames, out);
+            for (size_t frame = 0; frame < frames; ++frame)
+                CHECK(resultRight[frame] == doctest::Approx(right[frame]).epsilon(0.000001));
+        }
+        
+        SUBCASE("int32 with dither")
+        {
+            vector<int32_t> data(frames * 2);
+            TpdfDither dither;
+            interleaveConvert<Int32Format>(in, 2, frames, data.data(), dither);
+            CHECK(data[1] == 2147483647);
+            
+            deinterleaveConvert<Int32Format>(data.data(), 2, frames, out);
+            for (size_t frame = 0; frame < frames; ++frame)
+                CHECK(resultLeft[frame] == doctest::Approx(left[frame]).epsilon(0.000001));
+        }
+    }
+    
+    SUBCASE("TPDF dither")
+    {
+        // Triangular on [-1, 1): zero mean, a variance of 1/6 and no correlation between successive values
+        TpdfDither dither;
+        const size_t count = 100000;
+        double sum = 0, squares = 0, lagged = 0, previous = 0, minimum = 0, maximum = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto x = dither();
+            minimum = min(minimum, x);
+            maximum = max(maximum, x);
+            sum += x;
+            squares += x * x;
+            lagged += x * previous;
+            previous = x;
+        }
+        
+        CHECK(minimum >= -1);
+        CHECK(maximum < 1);
+        CHECK(sum / count == doctest::Approx(0).epsilon(0.01));
+        CHECK(squares / count == doctest::Approx(1.0 / 6).epsilon(0.01));
+        CHECK(lagged / count == doctest::Approx(0).epsilon(0.01));
+    }
+    
+    SUBCASE("complex layout conversion")
+    {
+        vector<complex<float>> x(16);
+        for (size_t i = 0; i < x.size(); ++i)
+            x[i] = {float(i), -float(i)};
+        
+        vector<float> real(x.size()), imag(x.size());
+        deinterleaveComplex(x.data(), x.size(), real.data(), imag.data());
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            CHECK(real[i] == x[i].real());
+            CHECK(imag[i] == x[i].imag());
+        }
+        
+        vector<complex<float>> y(x.size());
+        interleaveComplex(real.data(), imag.data(), x.size(), y.data());
+        CHECK(y == x);
+        
+        auto view = deinterleaveComplexInPlace(y.data(), y.size());
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            CHECK(view.real()[i] == real[i]);
+            CHECK(view.imag()[i] == imag[i]);
+            CHECK(view[i] == x[i]);
+        }
+        
+        interleaveComplexInPlace(y.data(), y.size());
+        CHECK(y == x);
+        
+        CHECK_THROWS_AS(deinterleaveComplexInPlace(y.data(), 12), std::invalid_argument);
+    }
+    
+    SUBCASE("ChannelView")
+    {
+        const vector<float> data = {1, -4, 2, 5, 3, -6};
+        ChannelView<const float*> left(data.data(), data.data() + data.size(), 2, 0);
+        ChannelView<vector<float>::const_iterator> right(data.begin(), data.end(), 2, 1);
+        
+        REQUIRE(left.size() == 3);
+        CHECK(left[2] == 3);
+        CHECK(vector<float>(left.begin(), left.end()) == vector<float>({1, 2, 3}));
+        
+        CHECK(mean<float>(left.begin(), left.end()) == doctest::Approx(2));
+        CHECK(*findExtrema(right.begin(), right.end()) == -6);
+        CHECK(dot(left.begin(), right.begin(), 3) == doctest::Approx(-4 + 10 - 18));
+        
+        vector<float> normalized(3);
+        normalize(right.begin(), right.end(), normalized.begin());
+        CHECK(normalized[2] == doctest::Approx(-1));
+        
+        CHECK(interpolate(left.begin(), left.end(), 0.5) == doctest::Approx(1.5));
+        
+        CHECK_THROWS_AS(ChannelView<const float*>(data.data(), data.data() + data.size(), 2, 2), std::invalid_argument);
+    }
+}
@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <stdexcept>
 #include <vector>
 
@@ -56,6 +58,49 @@ TEST_CASE("normalize")
         }
     }
     
+    SUBCASE("normalize() on pointers")
+    {
+        vector<double> x(200);
+        for (size_t i = 0; i < x.size(); ++i)
+            x[i] = sin(i * 0.1) * 0.25;
+        
+        vector<double> expected(x.size());
+        normalize(x.begin(), x.end(), expected.begin());
+        normalize(x.data(), x.data() + x.size(), x.data());
+        
+        for (size_t i = 0; i < x.size(); ++i)
+            CHECK(x[i] == doctest::Approx(expected[i]));
+        
+        CHECK(abs(*findExtrema(x.begin(), x.end())) == doctest::Approx(1));
+    }
+    
+    SUBCASE("normalize() on integers")
+    {
+        const vector<int> x = {1, 2, -4};
+        vector<double> y(x.size());
+        normalize(x.begin(), x.end(), y.begin());
+        
+        CHECK(y[0] == doctest::Approx(0.25));
+        CHECK(y[1] == doctest::Approx(0.5));
+        CHECK(y[2] == doctest::Approx(-1));
+    }
+    
+    SUBCASE("normalize() throws on silence and NaN")
+    {
+        vector<float> x(100, 0);
+        CHECK_THROWS_AS(normalize(x.data(), x.data() + x.size(), x.data()), std::runtime_error);
+        CHECK_THROWS_AS(normalize(x.begin(), x.end(), x.begin()), std::runtime_error);
+        
+        x[10] = NAN;
+        CHECK_THROWS_AS(normalize(x.begin(), x.end(), x.begin()), std::runtime_error);
+        
+        StreamingNormalizer<float> normalizer;
+        normalizer.analyze(x.data(), x.size());
+        x[10] = 1;
+        normalizer.analyze(x.data(), x.size());
+        CHECK_THROWS_AS(normalizer.getFactor(), std::runtime_error);
+    }
+    
     SUBCASE("normalizeArea()")
     {
         SUBCASE("Area equal to one")
@@ -75,5 +120,202 @@ TEST_CASE("normalize")
         }
     }
     
+    SUBCASE("StreamingNormalizer")
+    {
+        // A signal in uneven chunks, not a multiple of the lanes
+        vector<float> x(1000);
+        for (size_t i = 0; i < x.size(); ++i)
+            x[i] = sin(i * 0.01f) * 0.5f + 0.1f;
+        
+        x[617] = -0.8f;
+        
+        SUBCASE("peak")
+        {
+            StreamingNormalizer<float> normalizer;
+            normalizer.analyze(x.data(), 333);
+            normalizer.analyze(x.data() + 333, 667);
+            CHECK(normalizer.getPeak() == doctest::Approx(0.8));
+            
+            vector<float> y(x.size());
+            normalizer.process(x.data(), y.data(), 500);
+            normalizer.process(x.data() + 500, y.data() + 500, 500);
+            
+            vector<float> expected(x.size());
+            normalize(x.begin(), x.end(), expected.begin());
+            for (size_t i = 0; i < x.size(); ++i)
+                CHECK(y[i] == doctest::Approx(expected[i]));
+        }
+        
+        SUBCASE("area")
+        {
+            StreamingNormalizer<float> normalizer(NormalizationMode::AREA);
+            for (size_t i = 0; i < x.size(); i += 300)
+                normalizer.analyze(x.data() + i, min<size_t>(300, x.size() - i));
+            
+            CHECK(normalizer.getArea() == doctest::Approx(accumulate(x.begin(), x.end(), 0.0)).epsilon(1e-5));
+            
+            normalizer.process(x.data(), x.data(), x.size());
+            CHECK(accumulate(x.begin(), x.end(), 0.0) == doctest::Approx(1).epsilon(1e-5));
+        }
+        
+        SUBCASE("throws on silence")
+        {
+            StreamingNormalizer<float> normalizer;
+            vector<float> silence(100, 0);
+            normalizer.analyze(silence.data(), silence.size());
+            CHECK_THROWS_AS(normalizer.process(silence.data(), silence.data(), silence.size()), std::runtime_error);
+        }
+    }
     
+    SUBCASE("normalization modes")
+    {
+        // Not a multiple of the lanes, with an offset so z-score and min-max have something to remove
+        vector<double> x(1001);
+        for (size_t i = 0; i < x.size(); ++i)
+            x[i] = 1000 + sin(i * 0.37) * 3 + cos(i * 0.011);
+        
+        vector<double> y(x.size());
+        const auto n = static_cast<double>(x.size());
+        
+        SUBCASE("RMS")
+        {
+            normalizeRms(x.data(), y.data(), x.size(), 0.5);
+            CHECK(sqrt(inner_product(y.begin(), y.end(), y.begin(), 0.0) / n) == doctest::Approx(0.5));
+        }
+        
+        SUBCASE("z-score")
+        {
+            normalizeZScore(x.data(), y.data(), x.size());
+            const auto mean = accumulate(y.begin(), y.end(), 0.0) / n;
+            CHECK(mean == doctest::Approx(0).epsilon(1e-9));
+            CHECK(inner_product(y.begin(), y.end(), y.begin(), 0.0) / n == doctest::Approx(1));
+        }
+        
+        SUBCASE("min-max")
+        {
+            normalizeMinMax(x.data(), y.data(), x.size(), -2.0, 3.0);
+            CHECK(*min_element(y.begin(), y.end()) == doctest::Approx(-2));
+            CHECK(*max_element(y.begin(), y.end()) == doctest::Approx(3));
+            CHECK(min_element(y.begin(), y.end()) - y.begin() == min_element(x.begin(), x.end()) - x.begin());
+        }
+        
+        SUBCASE("L2")
+        {
+            normalizeL2(x.data(), x.data(), x.size());
+            CHECK(inner_product(x.begin(), x.end(), x.begin(), 0.0) == doctest::Approx(1));
+        }
+        
+        SUBCASE("streaming equals a single pass")
+        {
+            for (auto mode : {NormalizationMode::RMS, NormalizationMode::Z_SCORE, NormalizationMode::MIN_MAX, NormalizationMode::L2})
+            {
+                StreamingNormalizer<double> whole(mode);
+                StreamingNormalizer<double> chunked(mode);
+                whole.analyze(x.data(), x.size());
+                for (size_t i = 0; i < x.size(); i += 97)
+                    chunked.analyze(x.data() + i, min<size_t>(97, x.size() - i));
+                
+                CHECK(chunked.getFactor() == doctest::Approx(whole.getFactor()));
+                CHECK(chunked.getOffset() == doctest::Approx(whole.getOffset()));
+            }
+        }
+        
+        SUBCASE("throws on constant signals")
+        {
+            vector<float> constant(100, 3);
+            CHECK_THROWS_AS(normalizeZScore(constant.data(), constant.data(), constant.size()), std::runtime_error);
+            CHECK_THROWS_AS(normalizeMinMax(constant.data(), constant.data(), constant.size()), std::runtime_error);
+            
+            fill(constant.begin(), constant.end(), 0);
+            CHECK_THROWS_AS(normalizeRms(constant.data(), constant.data(), constant.size()), std::runtime_error);
+            CHECK_THROWS_AS(normalizeL2(constant.data(), constant.data(), constant.size()), std::runtime_error);
+        }
+    }
+    
+    SUBCASE("normalizeRows()")
+    {
+        const size_t rows = 37;
+        const size_t columns = 200;
+        vector<float> matrix(rows * columns);
+        for (size_t i = 0; i < matrix.size(); ++i)
+            matrix[i] = sin(i * 0.1f) * (1 + i / columns);
+        
+        SUBCASE("equals normalizing every row on its own")
+        {
+            vector<float> expected(matrix.size());
+            for (size_t row = 0; row < rows; ++row)
+                normalizeZScore(matrix.data() + row * columns, expected.data() + row * columns, columns);
+            
+            for (size_t threads : {1, 4, 100})
+            {
+                vector<float> output(matrix.size());
+                normalizeRows(matrix.data(), output.data(), rows, columns, NormalizationMode::Z_SCORE, threads);
+                
+                for (size_t i = 0; i < output.size(); ++i)
+                    CHECK(output[i] == doctest::Approx(expected[i]));
+            }
+        }
+        
+        SUBCASE("custom normalizer")
+        {
+            normalizeRows(matrix.data(), matrix.data(), rows, columns, [](const float* in, float* out, size_t size){ normalizeMinMax(in, out, size, -1.f, 1.f); });
+            
+            for (size_t row = 0; row < rows; ++row)
+            {
+                CHECK(*min_element(matrix.begin() + row * columns, matrix.begin() + (row + 1) * columns) == doctest::Approx(-1));
+                CHECK(*max_element(matrix.begin() + row * columns, matrix.begin() + (row + 1) * columns) == doctest::Approx(1));
+            }
+        }
+        
+        SUBCASE("rethrows")
+        {
+            fill(matrix.begin() + 30 * columns, matrix.begin() + 31 * columns, 0);
+            CHECK_THROWS_AS(normalizeRows(matrix.data(), matrix.data(), rows, columns, NormalizationMode::PEAK, 4), std::runtime_error);
+        }
+    }
+    
+    SUBCASE("LookAheadLimiter")
+    {
+        vector<float> x(2000);
+        for (size_t i = 0; i < x.size(); ++i)
+            x[i] = sin(i * 0.05f) * (i >= 1000 && i < 1100 ? 4.f : 0.5f);
+        
+        SUBCASE("limits without overshoot, delayed by the look-ahead")
+        {
+            LookAheadLimiter<float> limiter(64, 1, 200);
+            CHECK(limiter.getLatency() == 64);
+            
+            vector<float> y(x.size());
+            limiter.process(x.data(), y.data(), 777);
+            limiter.process(x.data() + 777, y.data() + 777, x.size() - 777);
+            
+            for (size_t i = 0; i < y.size(); ++i)
+                CHECK(abs(y[i]) <= 1 + 1e-5f);
+            
+            // Untouched before the loud part, as long as its look-ahead didn't see it yet
+            for (size_t i = 64; i < 1000; ++i)
+                CHECK(y[i] == doctest::Approx(x[i - 64]));
+            
+            // Limited all the way, and recovering afterwards
+            CHECK(*max_element(y.begin() + 1064, y.begin() + 1164) > 0.99f);
+            CHECK(limiter.getGain() > 0.9f);
+        }
+        
+        SUBCASE("normalizes with a maximum gain")
+        {
+            LookAheadLimiter<float> normalizer(64, 1, 500, 8);
+            normalizer.process(x.data(), x.data(), x.size());
+            
+            for (size_t i = 0; i < x.size(); ++i)
+                CHECK(abs(x[i]) <= 1 + 1e-5f);
+            
+            CHECK(*max_element(x.begin() + 500, x.begin() + 1000) == doctest::Approx(1).epsilon(1e-3));
+        }
+        
+        SUBCASE("throws")
+        {
+            CHECK_THROWS_AS(LookAheadLimiter<float>(64, 0), std::invalid_argument);
+            CHECK_THROWS_AS(LookAheadLimiter<float>(64, 1, 0, 0), std::invalid_argument);
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../constants.hpp"
+#include "../oversample.hpp"
+
+using namespace math;
+using namespace std;
+
+//! The magnitude of a single DFT bin
+static double binMagnitude(const vector<double>& signal, size_t bin)
+{
+    complex<double> sum = 0;
+    for (size_t n = 0; n < signal.size(); ++n)
+        sum += signal[n] * polar(1.0, -TAU<double> * bin * n / signal.size());
+    
+    return abs(sum) / signal.size();
+}
+
+TEST_CASE("Oversample")
+{
+    SUBCASE("designHalfband")
+    {
+        const auto coefficients = designHalfband(8);
+        REQUIRE(coefficients.size() == 16);
+        
+        double sum = 0;
+        for (size_t i = 0; i < coefficients.size(); ++i)
+        {
+            sum += coefficients[i];
+            CHECK(coefficients[i] == doctest::Approx(coefficients[coefficients.size() - 1 - i]));
+        }
+        
+        CHECK(sum == doctest::Approx(0.5));
+        CHECK_THROWS_AS(designHalfband(0), std::invalid_argument);
+    }
+    
+    SUBCASE("up and down is a delay")
+    {
+        const auto coefficients = designHalfband(12);
+        HalfbandUpsampler<double> upsampler(coefficients, 100);
+        HalfbandDownsampler<double> downsampler(coefficients, 100);
+        
+        // Odd sizes, to cross the chunk boundaries
+        vector<double> input(1000);
+        for (size_t i = 0; i < input.size(); ++i)
+            input[i] = sin(TAU<double> * 0.05 * i);
+        
+        vector<double> up(input.size() * 2);
+        vector<double> output(input.size());
+        upsampler.process(input.data(), up.data(), 377);
+        upsampler.process(input.data() + 377, up.data() + 754, input.size() - 377);
+        downsampler.process(up.data(), output.data(), input.size());
+        
+        const auto latency = (upsampler.getLatency() + downsampler.getLatency()) / 2;
+        REQUIRE(latency == 23);
+        for (size_t i = 100; i < input.size(); ++i)
+            CHECK(output[i] == doctest::Approx(input[i - latency]).epsilon(1e-4));
+    }
+    
+    SUBCASE("factor 1 equals the waveshaper")
+    {
+        vector<double> input(64);
+        for (size_t i = 0; i < input.size(); ++i)
+            input[i] = -2 + i / 16.0;
+        
+        OversampledWaveshaper<double, SigmoidTanShape> shaper(2, 3, 1);
+        vector<double> output(input.size());
+        shaper.process(input.data(), output.data(), input.size());
+        
+        CHECK(shaper.getLatency() == 0);
+        for (size_t i = 0; i < input.size(); ++i)
+            CHECK(output[i] == doctest::Approx(sigmoidTan(input[i], 2, 3)));
+    }
+    
+    SUBCASE("latency")
+    {
+        // A constant passes the shaper and filters unchanged once the filters have settled
+        for (size_t factor = 2; factor <= 8; factor *= 2)
+        {
+            OversampledWaveshaper<double, SigmoidShape> shaper(1, 1, factor, 16);
+            vector<double> ones(256, 1);
+            vector<double> output(ones.size());
+            shaper.process(ones.data(), output.data(), ones.size());
+            
+            const auto settled = static_cast<size_t>(ceil(shaper.getLatency())) * 2;
+            CHECK(output[settled] == doctest::Approx(sigmoid(1.0, 1, 1)).epsilon(1e-4));
+            CHECK(abs(output[0]) < 1e-3);
+        }
+        
+        CHECK((OversampledWaveshaper<float, SigmoidShape>(1, 1, 2, 64, 16).getLatency() == 31));
+        CHECK((OversampledWaveshaper<float, SigmoidShape>(1, 1, 4, 64, 16).getLatency() == 31 + 15 / 2.0));
+        CHECK((OversampledWaveshaper<float, SigmoidShape>(1, 1, 8, 64, 16).getLatency() == 31 + 15 / 2.0 + 15 / 4.0));
+    }
+    
+    SUBCASE("suppresses aliasing")
+    {
+        // A 0.3 cycles per sample sine, whose third harmonic aliases to 0.1
+        const size_t size = 4000;
+        vector<double> input(size * 2);
+        for (size_t i = 0; i < input.size(); ++i)
+            input[i] = sin(TAU<double> * 1200 * i / size);
+        
+        auto measure = [&](size_t factor)
+        {
+            OversampledWaveshaper<double, SigmoidTanShape> shaper(2, 2, factor);
+            vector<double> output(input.size());
+            shaper.process(input.data(), output.data(), input.size());
+            
+            // Skip the first half, to let the filters settle
+            const vector<double> tail(output.begin() + size, output.end());
+            return binMagnitude(tail, 400) / binMagnitude(tail, 1200);
+        };
+        
+        const auto base = measure(1);
+        CHECK(base > 1e-2);
+        CHECK(measure(2) < base * 1e-1);
+        CHECK(measure(4) < base * 1e-2);
+        CHECK(measure(8) < base * 1e-5);
+    }
+    
+    SUBCASE("in place")
+    {
+        vector<double> input(300);
+        for (size_t i = 0; i < input.size(); ++i)
+            input[i] = sin(TAU<double> * 0.01 * i);
+        
+        OversampledWaveshaper<double, SigmoidExpShape> a(2, 2, 4, 64);
+        OversampledWaveshaper<double, SigmoidExpShape> b(2, 2, 4, 64);
+        vector<double> output(input.size());
+        a.process(input.data(), output.data(), input.size());
+        b.process(input.data(), input.data(), input.size());
+        
+        for (size_t i = 0; i < input.size(); ++i)
+            CHECK(input[i] == doctest::Approx(output[i]));
+    }
+    
+    SUBCASE("throws")
+    {
+        CHECK_THROWS_AS((OversampledWaveshaper<float, SigmoidShape>(1, 1, 3)), std::invalid_argument);
+        CHECK_THROWS_AS((OversampledWaveshaper<float, SigmoidShape>(1, 1, 16)), std::invalid_argument);
+        CHECK_THROWS_AS((OversampledWaveshaper<float, SigmoidShape>(1, 1, 2, 0)), std::invalid_argument);
+        CHECK_THROWS_AS((OversampledWaveshaper<float, SigmoidShape>(0, 1, 2)), std::runtime_error);
+    }
+}
@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../noise.hpp"
+#include "../random.hpp"
+#include "../statistics.hpp"
+
+using namespace math;
+using namespace std;
+
+TEST_CASE("Random")
+{
+    SUBCASE("generateUniformRandom() for ranges")
+    {
+        mt19937 engine32(42);
+        mt19937_64 engine64(42);
+        minstd_rand engineOther(42);
+        
+        SUBCASE("float")
+        {
+            vector<float> x(10000);
+            generateUniformRandom(x.begin(), x.end(), -2, 3, engine32);
+            CHECK(*min_element(x.begin(), x.end()) >= -2);
+            CHECK(*max_element(x.begin(), x.end()) < 3);
+            CHECK(mean<double>(x.begin(), x.end()) == doctest::Approx(0.5).epsilon(0.05));
+        }
+        
+        SUBCASE("double")
+        {
+            vector<double> x(10000);
+            generateUniformRandom(x.begin(), x.end(), 0, 1, engine64);
+            CHECK(*min_element(x.begin(), x.end()) >= 0);
+            CHECK(*max_element(x.begin(), x.end()) < 1);
+            CHECK(mean<double>(x.begin(), x.end()) == doctest::Approx(0.5).epsilon(0.05));
+            
+            generateUniformRandom(x.begin(), x.end(), 0, 1, engineOther);
+            CHECK(mean<double>(x.begin(), x.end()) == doctest::Approx(0.5).epsilon(0.05));
+        }
+        
+        SUBCASE("int")
+        {
+            vector<int> x(10000);
+            generateUniformRandom(x.begin(), x.end(), -3, 3, engine32);
+            CHECK(*min_element(x.begin(), x.end()) == -3);
+            CHECK(*max_element(x.begin(), x.end()) == 3);
+            CHECK(mean<double>(x.begin(), x.end()) == doctest::Approx(0).epsilon(0.1));
+            
+            vector<uint32_t> full(100);
+            generateUniformRandom(full.begin(), full.end(), 0u, 0xFFFFFFFFu, engine64);
+            CHECK(*max_element(full.begin(), full.end()) > 0x80000000u);
+        }
+        
+        SUBCASE("generateUniformRandomBuffer()")
+        {
+            auto x = generateUniformRandomBuffer<float>(100, 5, 6, engine32);
+            CHECK(x.size() == 100);
+            CHECK(*min_element(x.begin(), x.end()) >= 5);
+            
+            // Writing to a non-forward output iterator, across several blocks
+            mt19937 engine1(4), engine2(4);
+            vector<float> y;
+            generateUniformRandomBuffer<float>(back_inserter(y), RANDOM_BLOCK_SIZE * 2 + 5, -1, 1, engine1);
+            CHECK(y == generateUniformRandomBuffer<float>(RANDOM_BLOCK_SIZE * 2 + 5, -1, 1, engine2));
+        }
+    }
+    
+    SUBCASE("engines")
+    {
+        SUBCASE("Pcg32")
+        {
+            Pcg32 engine(42, 54);
+            CHECK(engine() == 0xA15C02B7u);
+            CHECK(engine() == 0x7B47F409u);
+            CHECK(engine() == 0xBA1D3330u);
+            
+            Pcg32 skipped(42, 54);
+            skipped.discard(1000);
+            engine.discard(997);
+            CHECK(engine() == skipped());
+        }
+        
+        SUBCASE("Philox4x32")
+        {
+            Philox4x32 engine;
+            CHECK(engine() == 0x6627E8D5u);
+            CHECK(engine() == 0xE169C58Du);
+            CHECK(engine() == 0xBC57AC4Cu);
+            CHECK(engine() == 0x9B00DBD8u);
+            
+            // Bulk generation matches sequential generation
+            Philox4x32 sequential(7, 3);
+            Philox4x32 bulk(7, 3);
+            bulk();
+            sequential();
+            
+            vector<uint32_t> x(1000), y(1000);
+            generate(x.begin(), x.end(), ref(sequential));
+            bulk.generate(y.data(), y.data() + y.size());
+            CHECK(x == y);
+            CHECK(bulk.position() == 1001);
+            
+            Philox4x32 seeked(7, 3);
+            seeked.seek(1 + 999);
+            CHECK(seeked() == x[999]);
+        }
+        
+        SUBCASE("Xoshiro256StarStar")
+        {
+            Xoshiro256StarStar engine(5);
+            auto copy = engine;
+            copy.jump();
+            CHECK(engine() != copy());
+            
+            copy = engine;
+            const auto first = engine();
+            copy.discard(1);
+            CHECK(copy() == engine());
+            CHECK(first != engine());
+        }
+        
+        SUBCASE("use with the uniform generators")
+        {
+            Xoshiro256StarStar xoshiro;
+            Pcg32 pcg;
+            Philox4x32 philox;
+            
+            vector<float> x(10000);
+            generateUniformRandom(x.begin(), x.end(), 0, 1, xoshiro);
+            CHECK(mean<double>(x.begin(), x.end()) == doctest::Approx(0.5).epsilon(0.05));
+            generateUniformRandom(x.begin(), x.end(), 0, 1, pcg);
+            CHECK(mean<double>(x.begin(), x.end()) == doctest::Approx(0.5).epsilon(0.05));
+            generateUniformRandom(x.begin(), x.end(), 0, 1, philox);
+            CHECK(mean<double>(x.begin(), x.end()) == doctest::Approx(0.5).epsilon(0.05));
+            
+            CHECK(generateUniformRandom<int>(0, 10, pcg) <= 10);
+            CHECK(std::uniform_int_distribution<int>(0, 10)(philox) <= 10);
+        }
+    }
+    
+    SUBCASE("non-uniform distributions")
+    {
+        Philox4x32 engine(7);
+        vector<double> x(100000);
+        
+        SUBCASE("generateGaussianRandom()")
+        {
+            generateGaussianRandom(x.begin(), x.end(), 2, 3, engine);
+            CHECK(mean<double>(x.begin(), x.end()) == doctest::Approx(2).epsilon(0.02));
+            for (auto& sample : x)
+                sample -= 2;
+            CHECK(rootMeanSquare<double>(x.begin(), x.end()) == doctest::Approx(3).epsilon(0.02));
+            
+            // Roughly 0.27% of samples lie beyond 3 standard deviations, these pass through the tail
+            const auto outliers = count_if(x.begin(), x.end(), [](double sample){ return abs(sample) > 9; });
+            CHECK(outliers > 150);
+            CHECK(outliers < 400);
+            
+            vector<float> y(1000);
+            mt19937 engine32(3);
+            generateGaussianRandom(y.begin(), y.end(), 0, 1, engine32);
+            CHECK(mean<double>(y.begin(), y.end()) == doctest::Approx(0).epsilon(0.1));
+        }
+        
+        SUBCASE("generateExponentialRandom()")
+        {
+            generateExponentialRandom(x.begin(), x.end(), 4, engine);
+            CHECK(*min_element(x.begin(), x.end()) >= 0);
+            CHECK(mean<double>(x.begin(), x.end()) == doctest::Approx(0.25).epsilon(0.02));
+        }
+        
+        SUBCASE("generateLaplaceRandom()")
+        {
+            generateLaplaceRandom(x.begin(), x.end(), 1, 2, engine);
+            CHECK(all_of(x.begin(), x.end(), [](double sample){ return isfinite(sample); }));
+            CHECK(mean<double>(x.begin(), x.end()) == doctest::Approx(1).epsilon(0.05));
+            
+            // The variance of a Laplace distribution is 2b^2
+            for (auto& sample : x)
+                sample -= 1;
+            CHECK(meanSquare<double>(x.begin(), x.end()) == doctest::Approx(8).epsilon(0.05));
+        }
+        
+        SUBCASE("generateTriangularRandom()")
+        {
+            generateTriangularRandom(x.begin(), x.end(), -1, 1, engine);
+            CHECK(*min_element(x.begin(), x.end()) >= -1);
+            CHECK(*max_element(x.begin(), x.end()) < 1);
+            CHECK(mean<double>(x.begin(), x.end()) == doctest::Approx(0).epsilon(0.01));
+            CHECK(meanSquare<double>(x.begin(), x.end()) == doctest::Approx(1.0 / 6).epsilon(0.02));
+        }
+    }
+    
+    SUBCASE("colored noise")
+    {
+        Pcg32 engine(5);
+        
+        SUBCASE("PinkNoise")
+        {
+            PinkNoise<float> pink;
+            vector<float> x(50000);
+            pink.generate(x.begin(), x.begin() + 1000, engine);
+            pink.generate(x.begin() + 1000, x.end(), engine);
+            CHECK(*min_element(x.begin(), x.end()) >= -1);
+            CHECK(*max_element(x.begin(), x.end()) < 1);
+            
+            // Pink noise has far more correlation between neighbouring samples than white noise
+            double correlation = 0;
+            for (size_t i = 1; i < x.size(); ++i)
+                correlation += x[i] * x[i - 1];
+            CHECK(correlation / meanSquare<double>(x.begin(), x.end()) / x.size() > 0.5);
+        }
+        
+        SUBCASE("BrownNoise")
+        {
+            CHECK_THROWS_AS(BrownNoise<float>(1), std::invalid_argument);
+            
+            BrownNoise<double> brown(0.99);
+            vector<double> x(100000);
+            brown.generate(x.begin(), x.end(), engine);
+            CHECK(rootMeanSquare<double>(x.begin(), x.end()) == doctest::Approx(1).epsilon(0.15));
+            
+            brown.reset();
+            Pcg32 other(5);
+            vector<double> y(100000);
+            brown.generate(y.begin(), y.end(), other);
+            CHECK(x == y);
+        }
+    }
+    
+    SUBCASE("generateUniformRandomParallel()")
+    {
+        const size_t size = RANDOM_PARALLEL_CHUNK_SIZE * 5 + 123;
+        vector<float> single(size), multiple(size);
+        vector<int> singleInt(size), multipleInt(size);
+        
+        Philox4x32 engine1(9), engine2(9);
+        generateUniformRandomParallel(single.begin(), single.end(), -1, 1, engine1, 1);
+        generateUniformRandomParallel(multiple.begin(), multiple.end(), -1, 1, engine2, 4);
+        CHECK(single == multiple);
+        CHECK(engine1() == engine2());
+        
+        Xoshiro256StarStar engine3(9), engine4(9);
+        generateUniformRandomParallel(singleInt.begin(), singleInt.end(), 0, 6, engine3, 1);
+        generateUniformRandomParallel(multipleInt.begin(), multipleInt.end(), 0, 6, engine4, 3);
+        CHECK(singleInt == multipleInt);
+        
+        Pcg32 engine5(9), engine6(9);
+        generateUniformRandomParallel(single.begin(), single.end(), -1, 1, engine5, 2);
+        generateUniformRandomParallel(multiple.begin(), multiple.end(), -1, 1, engine6);
+        CHECK(single == multiple);
+        CHECK(mean<double>(single.begin(), single.end()) == doctest::Approx(0).epsilon(0.01));
+    }
+}
@@ -1,4 +1,6 @@
+#include <cmath>
 #include <stdexcept>
+#include <vector>
 
 #include "doctest.h"
 
@@ -37,3 +39,206 @@ TEST_CASE("WaveShaper")
         CHECK_THROWS_AS(sigmoidExp(0, 0, 0), std::runtime_error);
     }
 }
+
+TEST_CASE("SigmoidWaveshaper block")
+{
+    vector<double> input(101);
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = -2.5 + i * 0.05;
+    
+    vector<double> output(input.size());
+    
+    SUBCASE("matches the sample functions")
+    {
+        SigmoidWaveshaper<double> sigmoidShaper(2, 3);
+        sigmoidShaper.process(input.data(), output.data(), input.size());
+        for (size_t i = 0; i < input.size(); ++i)
+            CHECK(output[i] == doctest::Approx(sigmoid(input[i], 2, 3)));
+        
+        SigmoidTanWaveshaper<double> tanShaper(2, 3);
+        tanShaper.process(input.data(), output.data(), input.size());
+        for (size_t i = 0; i < input.size(); ++i)
+            CHECK(output[i] == doctest::Approx(sigmoidTan(input[i], 2, 3)));
+        
+        SigmoidExpWaveshaper<double> expShaper(2, 3);
+        expShaper.process(input.data(), output.data(), input.size());
+        for (size_t i = 0; i < input.size(); ++i)
+            CHECK(output[i] == doctest::Approx(sigmoidExp(input[i], 2, 3)));
+        
+        CHECK(expShaper.process(0.5) == doctest::Approx(sigmoidExp(0.5, 2, 3)));
+    }
+    
+    SUBCASE("fast math")
+    {
+        SigmoidTanWaveshaper<float, FastMath<>> shaper(2, 3);
+        vector<float> in(input.begin(), input.end());
+        vector<float> out(in.size());
+        shaper.process(in.data(), out.data(), in.size());
+        for (size_t i = 0; i < in.size(); ++i)
+            CHECK(out[i] == doctest::Approx(sigmoidTan(input[i], 2, 3)).epsilon(1e-5));
+    }
+    
+    SUBCASE("ramps to new factors over a block")
+    {
+        SigmoidWaveshaper<double> shaper(1, 1);
+        shaper.setFactors(4, 4);
+        CHECK(shaper.getPositiveFactor() == 1);
+        
+        vector<double> ones(64, 1);
+        shaper.process(ones.data(), output.data(), ones.size());
+        CHECK(shaper.getPositiveFactor() == 4);
+        
+        // Normalized, so x = 1 maps to 1 throughout the ramp
+        for (size_t i = 0; i < ones.size(); ++i)
+            CHECK(output[i] == doctest::Approx(1));
+        
+        shaper.process(input.data(), output.data(), input.size());
+        for (size_t i = 0; i < input.size(); ++i)
+            CHECK(output[i] == doctest::Approx(sigmoid(input[i], 4, 4)));
+    }
+    
+    SUBCASE("in place")
+    {
+        SigmoidExpWaveshaper<double> shaper(1, 2);
+        output = input;
+        shaper.process(output.data(), output.data(), output.size());
+        for (size_t i = 0; i < input.size(); ++i)
+            CHECK(output[i] == doctest::Approx(sigmoidExp(input[i], 1, 2)));
+    }
+    
+    SUBCASE("throw for distortion factor <= 0")
+    {
+        CHECK_THROWS_AS(SigmoidWaveshaper<float>(0, 1), std::runtime_error);
+        
+        SigmoidTanWaveshaper<float> shaper(1, 1);
+        CHECK_THROWS_AS(shaper.setFactors(1, -1), std::runtime_error);
+    }
+}
+
+template <class Shape>
+static void checkAntiderivatives()
+{
+    // Central differences of the antiderivatives should give back the function below
+    const double h = 1e-5;
+    for (double x = -3; x <= 3; x += 0.25)
+    {
+        const auto first = (Shape::template antiderivative<StandardMath>(x + h) - Shape::template antiderivative<StandardMath>(x - h)) / (2 * h);
+        const auto second = (Shape::template secondAntiderivative<StandardMath>(x + h) - Shape::template secondAntiderivative<StandardMath>(x - h)) / (2 * h);
+        CHECK(first == doctest::Approx(Shape::template apply<StandardMath>(x)).epsilon(1e-6));
+        CHECK(second == doctest::Approx(Shape::template antiderivative<StandardMath>(x)).epsilon(1e-6));
+    }
+    
+    CHECK(Shape::template antiderivative<StandardMath>(0.0) == 0);
+    CHECK(Shape::template secondAntiderivative<StandardMath>(0.0) == 0);
+}
+
+//! The magnitude of a single DFT bin, relative to the signal length
+static double binMagnitude(const vector<double>& signal, size_t bin)
+{
+    double real = 0;
+    double imaginary = 0;
+    for (size_t n = 0; n < signal.size(); ++n)
+    {
+        real += signal[n] * cos(6.283185307179586 * bin * n / signal.size());
+        imaginary -= signal[n] * sin(6.283185307179586 * bin * n / signal.size());
+    }
+    
+    return sqrt(real * real + imaginary * imaginary) / signal.size();
+}
+
+TEST_CASE("AntialiasedWaveshaper")
+{
+    SUBCASE("antiderivatives")
+    {
+        checkAntiderivatives<SigmoidShape>();
+        checkAntiderivatives<SigmoidTanShape>();
+        checkAntiderivatives<SigmoidExpShape>();
+    }
+    
+    SUBCASE("slow input is shaped with a delay")
+    {
+        vector<double> input(1000);
+        for (size_t i = 0; i < input.size(); ++i)
+            input[i] = 2 * sin(6.283185307179586 * 0.001 * i);
+        
+        vector<double> output(input.size());
+        
+        AntialiasedWaveshaper<double, SigmoidTanShape, 1> first(2, 3);
+        first.process(input.data(), output.data(), input.size());
+        CHECK(first.getLatency() == 0.5);
+        for (size_t i = 1; i < input.size(); ++i)
+            CHECK(abs(output[i] - sigmoidTan((input[i] + input[i - 1]) / 2, 2, 3)) < 1e-4);
+        
+        AntialiasedWaveshaper<double, SigmoidExpShape, 2> second(3, 3);
+        second.process(input.data(), output.data(), input.size());
+        CHECK(second.getLatency() == 1);
+        for (size_t i = 2; i < input.size(); ++i)
+            CHECK(abs(output[i] - sigmoidExp(input[i - 1], 3, 3)) < 1e-3);
+    }
+    
+    SUBCASE("constant input falls back to the shape")
+    {
+        vector<double> input(600, 0.7);
+        vector<double> output(input.size());
+        
+        AntialiasedWaveshaper<double, SigmoidShape, 1> first(1, 2);
+        first.process(input.data(), output.data(), input.size());
+        CHECK(output.back() == doctest::Approx(sigmoid(0.7, 1, 2)));
+        
+        AntialiasedWaveshaper<double, SigmoidShape, 2> second(1, 2);
+        second.process(input.data(), output.data(), input.size());
+        CHECK(output.back() == doctest::Approx(sigmoid(0.7, 1, 2)));
+        
+        AntialiasedWaveshaper<float, SigmoidTanShape, 2, FastMath<>> fast(1, 2);
+        vector<float> in(input.begin(), input.end());
+        vector<float> out(in.size());
+        fast.process(in.data(), out.data(), in.size());
+        CHECK(out.back() == doctest::Approx(sigmoidTan(0.7, 1, 2)).epsilon(1e-5));
+    }
+    
+    SUBCASE("suppresses aliasing")
+    {
+        // A 0.13 cycles per sample sine, whose fifth harmonic aliases to 0.35
+        const size_t size = 4000;
+        vector<double> input(size);
+        for (size_t i = 0; i < input.size(); ++i)
+            input[i] = sin(6.283185307179586 * 520 * i / size);
+        
+        vector<double> output(size);
+        SigmoidTanWaveshaper<double> plain(2, 2);
+        plain.process(input.data(), output.data(), size);
+        const auto base = binMagnitude(output, 1400) / binMagnitude(output, 520);
+        
+        AntialiasedWaveshaper<double, SigmoidTanShape, 1> first(2, 2);
+        first.process(input.data(), output.data(), size);
+        const auto firstOrder = binMagnitude(output, 1400) / binMagnitude(output, 520);
+        
+        AntialiasedWaveshaper<double, SigmoidTanShape, 2> second(2, 2);
+        second.process(input.data(), output.data(), size);
+        const auto secondOrder = binMagnitude(output, 1400) / binMagnitude(output, 520);
+        CHECK(firstOrder < base / 2);
+        CHECK(secondOrder < firstOrder / 2);
+    }
+    
+    SUBCASE("blocks and in place")
+    {
+        vector<double> input(700);
+        for (size_t i = 0; i < input.size(); ++i)
+            input[i] = 3 * sin(6.283185307179586 * 0.07 * i);
+        
+        AntialiasedWaveshaper<double, SigmoidShape, 2> a(2, 1);
+        AntialiasedWaveshaper<double, SigmoidShape, 2> b(2, 1);
+        vector<double> output(input.size());
+        a.process(input.data(), output.data(), input.size());
+        b.process(input.data(), input.data(), 123);
+        b.process(input.data() + 123, input.data() + 123, input.size() - 123);
+        
+        for (size_t i = 0; i < input.size(); ++i)
+            CHECK(input[i] == doctest::Approx(output[i]));
+    }
+    
+    SUBCASE("throw for distortion factor <= 0")
+    {
+        CHECK_THROWS_AS((AntialiasedWaveshaper<float, SigmoidShape, 1>(0, 1)), std::runtime_error);
+    }
+}
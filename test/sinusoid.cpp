@@ -0,0 +1,78 @@
+#include <cmath>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../constants.hpp"
+#include "../sinusoid.hpp"
+
+using namespace math;
+using namespace std;
+
+TEST_CASE("sinusoid")
+{
+    SUBCASE("SinusoidOscillator")
+    {
+        const double frequency = 0.0123456;
+        const double phase = 0.7;
+        
+        SUBCASE("matches sin() and cos()")
+        {
+            SinusoidOscillator<double> oscillator(frequency, phase, 0.5);
+            
+            // Use odd block sizes, so groups of lanes are split across calls
+            const size_t size = 100000;
+            vector<double> sine(size), cosine(size);
+            for (size_t i = 0; i < size; i += 37)
+                oscillator.generate(&sine[i], &cosine[i], min<size_t>(37, size - i));
+            
+            double error = 0;
+            for (size_t i = 0; i < size; ++i)
+            {
+                error = max(error, abs(sine[i] - 0.5 * sin(TAU<double> * frequency * i + phase)));
+                error = max(error, abs(cosine[i] - 0.5 * cos(TAU<double> * frequency * i + phase)));
+            }
+            
+            CHECK(error < 1e-9);
+        }
+        
+        SUBCASE("float stays bounded")
+        {
+            SinusoidOscillator<float> oscillator(frequency, phase);
+            vector<float> sine(1000000);
+            oscillator.generateSine(sine.data(), sine.size());
+            
+            double error = 0;
+            for (size_t i = sine.size() - 1000; i < sine.size(); ++i)
+                error = max(error, abs(sine[i] - sin(TAU<double> * frequency * i + phase)));
+            
+            CHECK(error < 1e-2);
+            for (size_t i = sine.size() - 1000; i < sine.size(); ++i)
+                CHECK(abs(sine[i]) < 1.0001);
+        }
+        
+        SUBCASE("setFrequency() continues the phase")
+        {
+            SinusoidOscillator<double> oscillator(frequency, phase);
+            vector<double> first(13), second(20);
+            oscillator.generateCosine(first.data(), first.size());
+            oscillator.setFrequency(frequency * 2);
+            oscillator.generateCosine(second.data(), second.size());
+            
+            const auto phase2 = TAU<double> * frequency * first.size() + phase;
+            for (size_t i = 0; i < second.size(); ++i)
+                CHECK(second[i] == doctest::Approx(cos(TAU<double> * frequency * 2 * i + phase2)));
+        }
+    }
+    
+    SUBCASE("generateSineBuffer() and generateCosineBuffer()")
+    {
+        const auto sine = generateSineBuffer<float>(1000, 3.5, 2);
+        const auto cosine = generateCosineBuffer<float>(1000, 3.5, 2);
+        for (size_t i = 0; i < sine.size(); ++i)
+        {
+            CHECK(sine[i] == doctest::Approx(2 * sin(TAU<double> * 3.5 * i / 1000)).epsilon(1e-5));
+            CHECK(cosine[i] == doctest::Approx(2 * cos(TAU<double> * 3.5 * i / 1000)).epsilon(1e-5));
+        }
+    }
+}
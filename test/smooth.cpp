@@ -0,0 +1,120 @@
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../smooth.hpp"
+
+using namespace math;
+using namespace std;
+
+TEST_CASE("SmoothedParameterBank")
+{
+    SmoothedParameterBank<double> bank(4, 64, 1);
+    
+    SUBCASE("settled")
+    {
+        bank.process(64);
+        CHECK(bank.getSmoothingCount() == 0);
+        for (size_t p = 0; p < bank.getParameterCount(); ++p)
+        {
+            for (size_t i = 0; i < 64; ++i)
+                CHECK(bank.getValues(p)[i] == 1);
+        }
+    }
+    
+    SUBCASE("linear")
+    {
+        // 100 samples, spanning two blocks
+        bank.setTarget(1, 2, 100);
+        CHECK(bank.isSmoothing(1));
+        CHECK(bank.getSmoothingCount() == 1);
+        
+        bank.process(64);
+        for (size_t i = 0; i < 64; ++i)
+            CHECK(bank.getValues(1)[i] == doctest::Approx(1 + (i + 1) / 100.0));
+        
+        CHECK(bank.getValues(0)[10] == 1);
+        CHECK(bank.getValue(1) == doctest::Approx(1.64));
+        
+        bank.process(64);
+        for (size_t i = 0; i < 64; ++i)
+            CHECK(bank.getValues(1)[i] == doctest::Approx(i < 36 ? 1.64 + (i + 1) / 100.0 : 2));
+        
+        CHECK(!bank.isSmoothing(1));
+        CHECK(bank.getValue(1) == 2);
+    }
+    
+    SUBCASE("ease")
+    {
+        bank.setTarget(2, 3, 50, EaseCurve::IN_OUT_CUBIC);
+        bank.process(30);
+        bank.process(30);
+        
+        // The second block continues where the first stopped
+        const auto row = bank.getValues(2);
+        for (size_t i = 0; i < 20; ++i)
+            CHECK(row[i] == doctest::Approx(1 + 2 * easeInOutCubic((31 + i) / 50.0)));
+        
+        for (size_t i = 20; i < 30; ++i)
+            CHECK(row[i] == 3);
+    }
+    
+    SUBCASE("one-pole")
+    {
+        bank.setTargetOnePole(3, 0, 1000);
+        
+        double previous = 1;
+        for (size_t block = 0; block < 16; ++block)
+        {
+            bank.process(64);
+            for (size_t i = 0; i < 64; ++i)
+            {
+                // Decays exponentially, so each sample covers the same fraction of the remaining distance
+                const auto value = bank.getValues(3)[i];
+                if (block * 64 + i < 999)
+                    CHECK(value == doctest::Approx(previous * pow(ONE_POLE_RESIDUE, 1 / 1000.0)));
+                
+                previous = value;
+            }
+        }
+        
+        CHECK(bank.getValue(3) == 0);
+        CHECK(bank.getSmoothingCount() == 0);
+    }
+    
+    SUBCASE("retarget")
+    {
+        // A new target starts from the current value
+        bank.setTarget(0, 2, 100);
+        bank.process(50);
+        bank.setTarget(0, 0, 10);
+        bank.process(10);
+        
+        CHECK(bank.getValues(0)[0] == doctest::Approx(1.5 - 0.15));
+        CHECK(bank.getValue(0) == 0);
+        
+        // A jump cancels the ramp
+        bank.setTarget(0, 2, 100);
+        bank.setValue(0, 5);
+        CHECK(bank.getSmoothingCount() == 0);
+        bank.process(64);
+        CHECK(bank.getValues(0)[63] == 5);
+    }
+    
+    SUBCASE("fast math")
+    {
+        SmoothedParameterBank<float, FastMath<>> fast(1, 64);
+        fast.setTargetOnePole(0, 1, 64);
+        fast.process(64);
+        for (size_t i = 0; i < 63; ++i)
+            CHECK(fast.getValues(0)[i] == doctest::Approx(1 - pow(ONE_POLE_RESIDUE, (i + 1) / 64.0)).epsilon(1e-3));
+    }
+    
+    SUBCASE("throws")
+    {
+        CHECK_THROWS_AS(bank.process(65), std::invalid_argument);
+        CHECK_THROWS_AS((SmoothedParameterBank<float>(1, 0)), std::invalid_argument);
+    }
+}
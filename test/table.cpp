@@ -0,0 +1,89 @@
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../sigmoid.hpp"
+#include "../table.hpp"
+
+using namespace math;
+using namespace std;
+
+TEST_CASE("FunctionTable")
+{
+    SUBCASE("linear functions are exact")
+    {
+        FunctionTable<double, LinearInterpolation> table([](double x){ return 2 * x + 1; }, -1, 1, 5);
+        CHECK(table.size() == 5);
+        CHECK(table.getMaxError() == doctest::Approx(0));
+        CHECK(table(0.3) == doctest::Approx(1.6));
+        CHECK(table(-1) == doctest::Approx(-1));
+        CHECK(table(1) == doctest::Approx(3));
+        
+        // Clamped to the domain
+        CHECK(table(5) == doctest::Approx(3));
+        CHECK(table(-5) == doctest::Approx(-1));
+    }
+    
+    SUBCASE("reports the interpolation error")
+    {
+        auto function = [](double x){ return sigmoidExp(x, 4, 4); };
+        FunctionTable<double> table(function, -2, 2, 65);
+        
+        double error = 0;
+        for (double x = -2; x <= 2; x += 0.001)
+            error = max(error, abs(table(x) - function(x)));
+        
+        CHECK(table.getMaxError() > 0);
+        CHECK(error < table.getMaxError() * 1.5);
+    }
+    
+    SUBCASE("refine")
+    {
+        auto function = [](double x){ return sigmoidTan(x, 3, 3); };
+        auto table = FunctionTable<double>::refine(function, -1, 1, 1e-7);
+        CHECK(table.getMaxError() <= 1e-7);
+        CHECK((table.size() - 1) % 15 == 0);
+        
+        for (double x = -1; x <= 1; x += 0.01)
+            CHECK(table(x) == doctest::Approx(function(x)).epsilon(1e-6));
+        
+        // Gives up at the maximum size
+        auto coarse = FunctionTable<double>::refine(function, -1, 1, 1e-15, TableSpacing::UNIFORM, 100);
+        CHECK(coarse.size() <= 100);
+        CHECK(coarse.getMaxError() > 1e-15);
+    }
+    
+    SUBCASE("logarithmic spacing")
+    {
+        auto function = [](double x){ return log(x); };
+        auto logarithmic = FunctionTable<double>::refine(function, 0.01, 100, 1e-6, TableSpacing::LOGARITHMIC);
+        auto uniform = FunctionTable<double>::refine(function, 0.01, 100, 1e-6, TableSpacing::UNIFORM);
+        CHECK(logarithmic.size() < uniform.size());
+        CHECK(logarithmic(0.05) == doctest::Approx(log(0.05)));
+        CHECK(logarithmic(50) == doctest::Approx(log(50)));
+    }
+    
+    SUBCASE("batch")
+    {
+        FunctionTable<float> table([](double x){ return sigmoid(x, 2, 5); }, -3, 3, 257);
+        vector<float> input(500);
+        for (size_t i = 0; i < input.size(); ++i)
+            input[i] = -4 + i * 0.016f;
+        
+        vector<float> output(input.size());
+        table(input.data(), output.data(), input.size());
+        for (size_t i = 0; i < input.size(); ++i)
+            CHECK(output[i] == table(input[i]));
+    }
+    
+    SUBCASE("throws")
+    {
+        auto function = [](double x){ return x; };
+        CHECK_THROWS_AS(FunctionTable<float>(function, 0, 1, 1), std::invalid_argument);
+        CHECK_THROWS_AS(FunctionTable<float>(function, 1, 1, 8), std::invalid_argument);
+        CHECK_THROWS_AS(FunctionTable<float>(function, 0, 1, 8, TableSpacing::LOGARITHMIC), std::invalid_argument);
+        CHECK_THROWS_AS(FunctionTable<float>::refine(function, 0, 1, 0), std::invalid_argument);
+    }
+}
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "doctest.h"
+
+#include "../constants.hpp"
+#include "../wavetable.hpp"
+
+using namespace math;
+using namespace std;
+
+TEST_CASE("wavetable")
+{
+    SUBCASE("Wavetable")
+    {
+        CHECK_THROWS_AS(Wavetable<float>::sawtooth(100), std::invalid_argument);
+        
+        const vector<double> harmonics = {1, 0, 0.5};
+        Wavetable<float> table(harmonics.begin(), harmonics.end(), 64);
+        CHECK(table.size() == 64);
+        CHECK(table.getLevelCount() == 2);
+        CHECK(table.getHarmonicCount(0) == 3);
+        CHECK(table.getHarmonicCount(1) == 1);
+        
+        const auto full = table.getLevel(0);
+        const auto fundamental = table.getLevel(1);
+        for (auto i = 0; i < 64; ++i)
+        {
+            CHECK(full[i] == doctest::Approx(sin(TAU<double> * i / 64) + 0.5 * sin(TAU<double> * 3 * i / 64)));
+            CHECK(fundamental[i] == doctest::Approx(sin(TAU<double> * i / 64)));
+        }
+        
+        // Guard samples
+        CHECK(full[-1] == full[63]);
+        CHECK(full[64] == full[0]);
+        CHECK(full[65] == full[1]);
+        
+        // Harmonics at 3 times 0.1 cycles per sample don't fit below Nyquist
+        CHECK(table.getLevelForFrequency(0.1) == 0);
+        CHECK(table.getLevelForFrequency(0.2) == 1);
+        
+        auto saw = Wavetable<float>::sawtooth(2048);
+        CHECK(saw.getHarmonicCount(0) == 1023);
+        CHECK(saw.getHarmonicCount(saw.getLevelForFrequency(0.01)) < 50);
+        CHECK(saw.getLevel(0)[512] == doctest::Approx(0.5).epsilon(0.01));
+    }
+    
+    SUBCASE("WavetableOscillatorBank")
+    {
+        const vector<double> harmonics = {1};
+        Wavetable<float> table(harmonics.begin(), harmonics.end(), 1024);
+        WavetableOscillatorBank<float> bank(table, 100);
+        CHECK(bank.getVoiceCount() == 100);
+        
+        vector<float> out(1000);
+        bank.process(out.data(), out.size());
+        CHECK(*max_element(out.begin(), out.end()) == 0);
+        
+        // Two voices, rendered in blocks that don't line up with the table
+        bank.setFrequency(3, 0.01);
+        bank.setAmplitude(3, 0.5);
+        bank.setFrequency(70, 0.0123);
+        bank.setPhase(70, 0.25);
+        bank.setAmplitude(70, 0.25);
+        for (size_t i = 0; i < out.size(); i += 333)
+            bank.process(&out[i], min<size_t>(333, out.size() - i));
+        
+        for (size_t i = 0; i < out.size(); ++i)
+        {
+            const auto expected = 0.5 * sin(TAU<double> * 0.01 * i) + 0.25 * sin(TAU<double> * (0.0123 * i + 0.25));
+            CHECK(out[i] == doctest::Approx(expected).epsilon(1e-4));
+        }
+    }
+}
@@ -0,0 +1,261 @@
+//
+//  wavetable.hpp
+//  Math
+//
+//  Copyright © 2015-2016 Dsperados (info@dsperados.com). All rights reserved.
+//  Licensed under the BSD 3-clause license.
+//
+
+#ifndef DSPERADOS_MATH_WAVETABLE_HPP
+#define DSPERADOS_MATH_WAVETABLE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "constants.hpp"
+#include "interpolation.hpp"
+#include "sinusoid.hpp"
+#include "utility.hpp"
+
+namespace math
+{
+    //! Band-limited, mip-mapped wavetable
+    /*! Built additively from the amplitudes of its sine harmonics. Every level of the mip-map holds
+        half the harmonics of the level before it, so that a level can be chosen per frequency that
+        doesn't alias. Each level is padded with guard samples, so four-point interpolation never needs to
+        wrap its index.
+        
+        @code{cpp}
+        auto table = Wavetable<float>::sawtooth(2048);
+        
+        // Read level for 440 Hz at 44.1 kHz
+        auto samples = table.getLevel(table.getLevelForFrequency(440.0 / 44100.0));
+        @endcode */
+    template <typename T>
+    class Wavetable
+    {
+    public:
+        //! The number of guard samples before and after each level
+        static constexpr std::size_t GUARD_BEFORE = 1;
+        static constexpr std::size_t GUARD_AFTER = 2;
+        
+    public:
+        //! Construct the wavetable from the amplitudes of its sine harmonics, starting at the fundamental
+        /*! Harmonics that don't fit in the table (at or above size / 2) are dropped
+            @throw std::invalid_argument if size is not a power of 2 larger than 2 */
+        template <class InputIterator>
+        Wavetable(InputIterator harmonicsBegin, InputIterator harmonicsEnd, std::size_t size) :
+            tableSize(size)
+        {
+            if (size <= 2 || !isPowerOf2(size))
+                throw std::invalid_argument("size is not a power of 2 larger than 2");
+            
+            std::vector<double> harmonics(harmonicsBegin, harmonicsEnd);
+            harmonics.resize(std::max<std::size_t>(std::min(harmonics.size(), size / 2 - 1), 1), 0);
+            
+            // Every level halves the number of harmonics, down to only the fundamental
+            for (auto count = harmonics.size(); count > 0; count /= 2)
+                harmonicCounts.emplace_back(count);
+            
+            // Build the levels from the fewest harmonics up, adding only the missing harmonics each time
+            const auto stride = size + GUARD_BEFORE + GUARD_AFTER;
+            data.resize(harmonicCounts.size() * stride);
+            std::vector<double> sum(size, 0);
+            std::vector<double> partial(size);
+            std::size_t harmonic = 0;
+            for (auto level = harmonicCounts.size(); level-- > 0;)
+            {
+                for (; harmonic < harmonicCounts[level]; ++harmonic)
+                {
+                    if (harmonics[harmonic] == 0)
+                        continue;
+                    
+                    SinusoidOscillator<double> oscillator((harmonic + 1) / static_cast<double>(size), 0, harmonics[harmonic]);
+                    oscillator.generateSine(partial.data(), size);
+                    for (std::size_t i = 0; i < size; ++i)
+                        sum[i] += partial[i];
+                }
+                
+                auto samples = &data[level * stride + GUARD_BEFORE];
+                std::copy(sum.begin(), sum.end(), samples);
+                for (std::size_t i = 1; i <= GUARD_BEFORE; ++i)
+                    samples[-static_cast<std::ptrdiff_t>(i)] = samples[size - i];
+                for (std::size_t i = 0; i < GUARD_AFTER; ++i)
+                    samples[size + i] = samples[i];
+            }
+        }
+        
+        //! A band-limited sawtooth, rising from -1 to 1
+        static Wavetable sawtooth(std::size_t size)
+        {
+            std::vector<double> harmonics(size / 2);
+            for (std::size_t k = 1; k <= harmonics.size(); ++k)
+                harmonics[k - 1] = (k % 2 ? 2 : -2) / (PI<double> * k);
+            
+            return {harmonics.begin(), harmonics.end(), size};
+        }
+        
+        //! A band-limited square wave between -1 and 1
+        static Wavetable square(std::size_t size)
+        {
+            std::vector<double> harmonics(size / 2);
+            for (std::size_t k = 1; k <= harmonics.size(); k += 2)
+                harmonics[k - 1] = 4 / (PI<double> * k);
+            
+            return {harmonics.begin(), harmonics.end(), size};
+        }
+        
+        //! A band-limited triangle wave between -1 and 1
+        static Wavetable triangle(std::size_t size)
+        {
+            std::vector<double> harmonics(size / 2);
+            for (std::size_t k = 1; k <= harmonics.size(); k += 2)
+                harmonics[k - 1] = (k % 4 == 1 ? 8 : -8) / (PI<double> * PI<double> * k * k);
+            
+            return {harmonics.begin(), harmonics.end(), size};
+        }
+        
+        //! The first sample of a level
+        /*! GUARD_BEFORE samples before and GUARD_AFTER samples after the level can be read as well */
+        const T* getLevel(std::size_t level) const { return &data[level * (tableSize + GUARD_BEFORE + GUARD_AFTER) + GUARD_BEFORE]; }
+        
+        //! The level with the most harmonics that won't alias at a frequency
+        /*! @param frequency The fundamental frequency in cycles per sample */
+        std::size_t getLevelForFrequency(double frequency) const
+        {
+            const auto limit = std::abs(frequency) * 2;
+            for (std::size_t level = 0; level < harmonicCounts.size(); ++level)
+                if (harmonicCounts[level] * limit < 1)
+                    return level;
+            
+            return harmonicCounts.size() - 1;
+        }
+        
+        //! The number of harmonics at a level
+        std::size_t getHarmonicCount(std::size_t level) const { return harmonicCounts[level]; }
+        
+        //! The number of levels
+        std::size_t getLevelCount() const { return harmonicCounts.size(); }
+        
+        //! The number of samples per level, without the guard samples
+        std::size_t size() const { return tableSize; }
+        
+    private:
+        //! The samples of every level, each surrounded by guard samples
+        std::vector<T> data;
+        
+        //! The number of harmonics per level
+        std::vector<std::size_t> harmonicCounts;
+        
+        //! The number of samples per level
+        std::size_t tableSize = 0;
+    };
+    
+    //! Bank of oscillators reading from a shared wavetable
+    /*! The voice state is stored as a structure of arrays. Phases are 32-bit fixed-point, so they wrap
+        by themselves on overflow, and the guard samples of the wavetable make every Catmull-Rom interpolation
+        read contiguous. Per voice the sample loop has no loop-carried dependency besides the output,
+        so compilers can vectorize it (using gathers where the instruction set has them).
+        
+        @code{cpp}
+        auto table = Wavetable<float>::sawtooth(2048);
+        WavetableOscillatorBank<float> bank(table, 64);
+        
+        bank.setFrequency(0, 440.0 / 44100.0);
+        bank.setAmplitude(0, 0.5);
+        bank.process(output.data(), output.size());
+        @endcode */
+    template <typename T>
+    class WavetableOscillatorBank
+    {
+    public:
+        //! Construct the bank with a number of silent voices
+        /*! The wavetable needs to outlive the bank */
+        WavetableOscillatorBank(const Wavetable<T>& table, std::size_t voiceCount) :
+            table(&table),
+            phases(voiceCount, 0),
+            increments(voiceCount, 0),
+            amplitudes(voiceCount, 0),
+            levels(voiceCount, table.getLevel(0)),
+            indexShift(32 - static_cast<std::uint32_t>(std::log2(table.size())))
+        {
+        }
+        
+        //! Render the sum of all voices, overwriting the output
+        void process(T* out, std::size_t size)
+        {
+            std::fill(out, out + size, 0);
+            
+            const auto fractionScale = static_cast<T>(1.0 / (std::uint64_t{1} << indexShift));
+            const auto fractionMask = (std::uint32_t{1} << indexShift) - 1;
+            for (std::size_t voice = 0; voice < phases.size(); ++voice)
+            {
+                if (amplitudes[voice] == 0)
+                    continue;
+                
+                const auto samples = levels[voice];
+                const auto phase = phases[voice];
+                const auto increment = increments[voice];
+                const auto amplitude = amplitudes[voice];
+                
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    const std::uint32_t p = phase + static_cast<std::uint32_t>(i) * increment;
+                    const auto index = static_cast<std::ptrdiff_t>(p >> indexShift);
+                    const auto fraction = static_cast<T>(p & fractionMask) * fractionScale;
+                    
+                    out[i] += amplitude * interpolateCatmullRom(fraction, samples[index - 1], samples[index], samples[index + 1], samples[index + 2]);
+                }
+                
+                phases[voice] = phase + static_cast<std::uint32_t>(size) * increment;
+            }
+        }
+        
+        //! Set the frequency of a voice, in cycles per sample
+        /*! Also picks the wavetable level that won't alias at this frequency */
+        void setFrequency(std::size_t voice, double frequency)
+        {
+            increments[voice] = static_cast<std::uint32_t>(static_cast<std::int64_t>(std::llround(frequency * 4294967296.0)));
+            levels[voice] = table->getLevel(table->getLevelForFrequency(frequency));
+        }
+        
+        //! Set the amplitude of a voice, voices with amplitude 0 are skipped
+        void setAmplitude(std::size_t voice, T amplitude) { amplitudes[voice] = amplitude; }
+        
+        //! Set the phase of a voice, in cycles
+        void setPhase(std::size_t voice, double phase)
+        {
+            phase -= std::floor(phase);
+            phases[voice] = static_cast<std::uint32_t>(static_cast<std::uint64_t>(phase * 4294967296.0));
+        }
+        
+        //! The number of voices
+        std::size_t getVoiceCount() const { return phases.size(); }
+        
+    private:
+        //! The wavetable shared by all voices
+        const Wavetable<T>* table = nullptr;
+        
+        //! The phase per voice, as a 32-bit fraction of a cycle
+        std::vector<std::uint32_t> phases;
+        
+        //! The phase increment per sample per voice, as a 32-bit fraction of a cycle
+        std::vector<std::uint32_t> increments;
+        
+        //! The amplitude per voice
+        std::vector<T> amplitudes;
+        
+        //! The wavetable level per voice
+        std::vector<const T*> levels;
+        
+        //! The number of fractional bits in the phase, below the table index
+        std::uint32_t indexShift = 0;
+    };
+}
+
+#endif